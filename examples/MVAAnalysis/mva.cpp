@@ -7,10 +7,12 @@
 // include local
 #include "DefinedMVAs.hpp"
 #include "TMVAClassification.hpp"
+#include "TMVAClassificationDriver.hpp"
 #include "TMVAReader.hpp"
 #include "TreeWriter.hpp"
 
 // Boost
+#include <boost/lexical_cast.hpp>
 #include <boost/program_options.hpp>
 
 // Hudson
@@ -45,7 +47,8 @@ void usage( const char* name ) {
 int main(int argc, const char* argv[]) {
 
   std::string inputFileName(""), treepath("data"), outputFileName("");
-  std::vector<std::string> mvaMethods, inputvars, inputfiles;
+  std::vector<std::string> mvaMethods, inputvars, inputfiles, grid;
+  unsigned int nJobs(0);
   try {
 
     /*
@@ -60,7 +63,9 @@ int main(int argc, const char* argv[]) {
   	("tree_path", po::value<std::string>(&treepath),     		"the path to the tree inside the input.root file passed in (data)")
   	("output_file",   po::value<std::string>(&outputFileName), 	"optional argument to store data from input.root as well the MVA response to a new file, if no argument is set, input.root get over written")       
 	( "mva", 		   boost::program_options::value< std::vector< std::string > >( &mvaMethods )->multitoken(), "specifies the training MVAs to use. Options are: Cuts, CutsD, CutsPCA, CutsGA, CutsSA\nLikelihood, LikelihoodD, LikelihoodPCA, LikelihoodKDE, LikelihoodMIX\nPDERS, PDERSD, PDERSPCA, PDEFoam, PDEFoamBoost, KNN\nMLP, MLPBFGS, MLPBNN, CFMlpANN, TMlpANN\nSVM, BDT, BDTG, BDTB, BDTD" )
-        ( "var",             boost::program_options::value< std::vector< std::string > >( &inputvars )->multitoken(), "specify the training variables to use." );
+        ( "var",             boost::program_options::value< std::vector< std::string > >( &inputvars )->multitoken(), "specify the training variables to use." )
+        ( "jobs,j",          po::value<unsigned int>(&nJobs),    "train each method in its own worker process, running at most this many at once (0 trains sequentially)" )
+        ( "grid",            boost::program_options::value< std::vector< std::string > >( &grid )->multitoken(), "additional option variants to train with --jobs, given as METHOD:OPTIONS" );
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -127,32 +132,46 @@ int main(int argc, const char* argv[]) {
     inputvars.push_back("MACD_signal"); 
   }
 
+    // Options overriding the DefinedMVAs defaults
+    std::map< std::string, std::string > methodOptions;
+    methodOptions["BDTD"] = NN::DefinedMVAs.find("BDTD")->second + ":PrunStrength=100";
+    methodOptions["BDT"] = "!H:!V:NTrees=150:MaxDepth=3:BoostType=AdaBoost:AdaBoostBeta=0.2:SeparationType=GiniIndex:nCuts=20:VarTransform=D,P,G,N:CreateMVAPdfs:PruneStrength=50000:PruneBeforeBoost";
+
+    // Train every method and option variant in parallel worker processes
+    if( trainer && nJobs > 0 ) {
+      NN::TMVAClassificationDriver driver( inputvars );
+      driver.setInput( inputFileName, treepath );
+
+      for( std::vector< std::string >::const_iterator it = mvaMethods.begin(); it != mvaMethods.end(); ++it ) {
+        driver.addMethod( *it, methodOptions.count( *it ) ? methodOptions[ *it ] : "" );
+      }
+      for( std::size_t i(0); i < grid.size(); ++i ) {
+        const std::string::size_type pos = grid[i].find(':');
+        const std::string method = grid[i].substr( 0, pos );
+        driver.addJob( method + "_" + boost::lexical_cast<std::string>( i ), method, pos == std::string::npos ? "" : grid[i].substr( pos + 1 ) );
+      }
+
+      driver.run( nJobs );
+      driver.printSummary();
+      trainer = false;
+    }
+
     // Begin training the networks
     if( trainer ) {
       NN::TMVAClassification* classifier = new NN::TMVAClassification( mvaMethods, inputvars);
 
       TFile *file = TFile::Open( inputFileName.c_str() );
-      TTree *treeS = dynamic_cast< TTree* > ( file->Get( treepath.c_str() ) );
-      TTree *treeB = dynamic_cast< TTree* > ( file->Get( treepath.c_str() ) );
-
-      std::cout << "Before cut Signal entries: " << treeS->GetEntries() << std::endl;
-      std::cout << "Before cut Background entries: " << treeB->GetEntries() << std::endl;
-      treeS = treeS->CopyTree( "nsig>1.01" );
-      treeB = treeB->CopyTree( "nbkg>1.01" );
-      std::cout << "After cut Signal entries: " << treeS->GetEntries() << std::endl;
-      std::cout << "After cut Background entries: " << treeB->GetEntries() << std::endl;
-      // set the signal and background trees
-      classifier->setSignalAndBackgroundTrees( treeS, treeB, 1., 1.);
-  
-      // set the weighting expressions if you have them in the trees.
-      classifier->setBackgroundWeightExpression( "nsig_S_sw" );
-      classifier->setSignalWeightExpression( "nbkg_B_sw" );
+      TTree *tree = dynamic_cast< TTree* > ( file->Get( treepath.c_str() ) );
+
+      // split the tuple into signal and background in a single pass, weighting
+      // signal by nbkg_B_sw and background by nsig_S_sw.
+      classifier->setSignalAndBackground( tree, "nsig>1.01", "nbkg>1.01", "nbkg_B_sw", "nsig_S_sw" );
       classifier->prepareTestAndTrain( );
 
       //classifier->prepareTestAndTrain("SOME WIERD STRING SETTINGS");
       classifier->bookMethods();
-      classifier->setOptions( "BDTD", NN::DefinedMVAs.find("BDTD")->second + ":PrunStrength=100" );
-      classifier->setOptions( "BDT", "!H:!V:NTrees=150:MaxDepth=3:BoostType=AdaBoost:AdaBoostBeta=0.2:SeparationType=GiniIndex:nCuts=20:VarTransform=D,P,G,N:CreateMVAPdfs:PruneStrength=50000:PruneBeforeBoost" );
+      classifier->setOptions( "BDTD", methodOptions["BDTD"] );
+      classifier->setOptions( "BDT", methodOptions["BDT"] );
       //classifier->setOptions( "MLP", "!H:!V:NeuronType=tanh:VarTransform=P,D,N:NCycles=400:HiddenLayers=N+2:TestRate=10:!UseRegulator:CreateMVAPdfs:UseRegulator:EpochMonitoring" );  
       //classifier->basicSetup( treeS, treeB );
       //classifier->setOptions( "TMlpANN", NN::DefinedMVAs.find("TMlpANN")->second + ":VarTransform=D,G_Signal,N" );
@@ -4,8 +4,10 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <iomanip>
 #include <set>
 #include <cstdlib>
+#include <cmath>
 
 // Boost
 #include <boost/program_options.hpp>
@@ -17,6 +19,9 @@
 #include "TMVAReader.hpp"
 #include "TreeWriter.hpp"
 #include "MVABacktester.hpp"
+#include "MVACutSweep.hpp"
+#include "MVAPipeline.hpp"
+#include "SignalBootstrap.hpp"
 
 // Hudson
 #include <YahooDriver.hpp>
@@ -31,6 +36,7 @@
 #include <EOMReport.hpp>
 #include <PortfolioReturns.hpp>
 #include <PortfolioReport.hpp>
+#include <ReportSink.hpp>
 
 using namespace std;
 using namespace boost::gregorian;
@@ -50,7 +56,9 @@ int main(int argc, const char* argv[]) {
 	std::string spx_dbfile;
 	Float_t cutValue = -0.01,  cutval_min(-0.001), cutval_max(1.0);
 	std::string mvaMethod("TMlpANN");
+	std::string reportFormat("text"), reportFile;
 	int dayshift = 7, N(1), type(0);
+	unsigned nThreads(0), nPaths(0), blockLength(5);
 	std::vector<std::string> inputvars;
 
 	/*
@@ -67,9 +75,15 @@ int main(int argc, const char* argv[]) {
 		("mva_type",   po::value<string>(&mvaMethod),      "the mva type you wish to test (BDTD).")
 		("cut_value",  po::value<Float_t>(&cutValue),      "the minimum mva cut value in which to buy an asset.")
 		("iters",      po::value<int>(&N),	           "the number of iterations to loop over toy.")
+		("jobs,j",     po::value<unsigned>(&nThreads),     "the number of backtests to run at once, all cores by default (0).")
+		("scan",                                           "only scan the trade statistics of the cut values on the scores, without monthly returns.")
+		("bootstrap",  po::value<unsigned>(&nPaths),       "only resample the trades of the cut value into this many paths and print ROI and drawdown intervals.")
+		("block",      po::value<unsigned>(&blockLength),  "trades per block when bootstrapping (5).")
 		("cut_type",   po::value<int>(&type),	           "set the mva cut type where it is standard (0), random (1) or a probability transfrom between 0-1 (2).")
 		("cut_min",  po::value<Float_t>(&cutval_min),      "the minimum range mva cut value in which to buy an asset.")
 		("cut_max",  po::value<Float_t>(&cutval_max),      "the maximum range mva cut value in which to buy an asset.")
+		("report_format", po::value<string>(&reportFormat), "write the results as text (default), csv, jsonl or binary.")
+		("report_file", po::value<string>(&reportFile),     "results file for the csv, jsonl and binary formats, - for the standard output (mva_backtester.<format>).")
   		("day_shift",   po::value<int>(&dayshift),         "time period (day shift) for calculating signal and background weights (7).") 
         	( "var", po::value< std::vector< std::string > >( &inputvars )->multitoken(), "specify the training variables to use." )
 		;
@@ -107,6 +121,14 @@ int main(int argc, const char* argv[]) {
 
 	try {
 
+		// Machine readable results go through a ReportSink, text is printed as before
+		ReportSinkPtr sink;
+		if( reportFormat != "text" ) {
+			const ReportSink::Format fmt = ReportSink::format_from_str( reportFormat );
+			if( reportFile.empty() ) reportFile = "mva_backtester." + ReportSink::format_str( fmt );
+			sink = ReportSink::create( fmt, reportFile );
+		}
+
 		/*
 		 * Load series data
 		 */
@@ -187,16 +209,21 @@ int main(int argc, const char* argv[]) {
 			app.initialise();
 			
 			MVABacktester::Type define_type = static_cast<MVABacktester::Type>( type );
-			for (int i(0); i < N ; ++i ) {
+
+			// Score every bar once, all backtests trade on the same values
+			MVAPipeline pipeline( spx_db, app, leaves, dayshift );
+			pipeline.initialise();
+			boost::shared_ptr< const std::vector<Float_t> > scores = pipeline.score( mvaMethod, inputvars, "weights" );
+
+			MVACutSweep sweep( spx_db, app, mvaMethod, scores, load_begin, load_end, rf_rate );
+			std::vector<CutResult> results;
+
+			if( N == 1 ) {
+				// A single cut is backtested once, the reports and the tree row come from the same run
+				const UInt_t seed = UInt_t( rand() );
 				MVABacktester backtester( spx_db, app, mvaMethod, cutValue);
-				backtester.setup( inputvars, leaves, "outputFile.root", "weights" );	
-				
-				if( N > 1 && define_type != MVABacktester::Random ) {
-				    cutValue = cutval_min + ( ( cutval_max - cutval_min) / N ) * i;
-                                }
-				
-				backtester.setCutValue( cutValue );
-				backtester.setSeed( UInt_t( i * rand() ) );
+				backtester.setScores( scores );
+				backtester.setSeed( seed );
 
 				backtester.run( dayshift, static_cast<MVABacktester::Type>(define_type) );
 
@@ -223,12 +250,6 @@ int main(int argc, const char* argv[]) {
 				Report rp(spx_eomrf);
 				rp.print();
 
-				// Print Position stats
-				/*Report::header("Position stats");
-				  PositionFactorsSet pf( backtester.positions().stratPos().closed());
-				  PositionsReport pr(pf);
-				  pr.print();*/
-
 				// Position analysis
 				//Report::header("Positions");
 				PositionFactorsSet pfs(backtester.positions());
@@ -241,44 +262,112 @@ int main(int argc, const char* argv[]) {
 				prns.add( &spx_eomrf2 );
 				PortfolioReport preport(prns);
 				preport.print();
-				//Report::precision(2);
-
-				/*eomrp.roi();
-				  eomrp.cagr();
-				  eomrp.gsdm();
-				  eomrp.sharpe();
-				  eomrp.roi();*/
-
-				treeWriter.column( "mvaCutValue", cutValue );
-				treeWriter.column( "SHARPE", spx_eomrf2.sharpe() );
-				treeWriter.column( "ROIEOM", spx_eomrf2.roi() );
-				treeWriter.column( "CAGR", spx_eomrf2.cagr() );
-				treeWriter.column( "GSDM", spx_eomrf2.gsd() );
-
-  				PositionSet pset = spx_eomrf.dd(); 
-				double maxdd(0.0);
-				if( !pset.empty() ) {
-					ReturnFactors ddrf( pset );
-					maxdd = ddrf.roi();
+
+				// A sink takes one table per run, --scan writes its own
+				if( sink && !vm.count("scan") ) {
+					ReportTable table( "backtest" );
+					table.add_row();
+					table.set( "cut", cutValue );
+					rp.fill( table );
+					eomrp.fill( table, "spx_" );
+					pr.fill( table );
+					preport.fill( table, "portfolio_" );
+					sink->write( table );
 				}
-				
-				treeWriter.column( "MAXDD", maxdd );
-
-				treeWriter.column( "ROI", spx_eomrf.roi() );
-				treeWriter.column( "STDDEV", spx_eomrf.stddev() );
-				treeWriter.column( "SKEW", spx_eomrf.skew() );
-				treeWriter.column( "AVE", spx_eomrf.avg() );
-				treeWriter.column( "nPositions", spx_eomrf.num() );
-				treeWriter.write();
-				// BnH
-				/*Report::header("SPX BnH");
-				  BnHTrader bnh(spx_db); 
-				  bnh.run();
-				  bnh.positions().print();
-				  EOMReturnFactors bnh_eomrf(bnh.positions(), load_begin, load_end);
-				  EOMReport bnh_rp(bnh_eomrf);
-				 */
 
+				results.push_back( sweep.evaluate( backtester, cutValue, seed ) );
+			}
+
+			std::vector<Float_t> cuts;
+			std::vector<UInt_t> seeds;
+			for (int i(0); i < N ; ++i ) {
+				if( N > 1 && define_type != MVABacktester::Random ) {
+				    cutValue = cutval_min + ( ( cutval_max - cutval_min) / N ) * i;
+                                }
+				cuts.push_back( cutValue );
+				seeds.push_back( UInt_t( i * rand() ) );
+			}
+
+			if( nPaths ) {
+				MVABacktester sampler( spx_db, app, mvaMethod );
+				sampler.setScores( scores );
+				std::vector<Float_t> barScores;
+				std::vector<double> factors;
+				sampler.tradeFactors( barScores, factors, dayshift, define_type == MVABacktester::Random ? MVABacktester::MVABasic : define_type );
+
+				SignalBootstrap bootstrap( barScores, factors );
+				Report::header("Bootstrap");
+				std::cout << std::setw(16) << "Mode" << std::setw(10) << "Trades" << std::setw(10) << "ROI" << std::setw(24) << "ROI 95%"
+					  << std::setw(10) << "MaxDD" << std::setw(24) << "MaxDD 95%" << std::setw(10) << "p random" << std::endl;
+				for( int mode = SignalBootstrap::BlockBootstrap; mode <= SignalBootstrap::RandomEntry; ++mode ) {
+					const BootstrapResult res = bootstrap.run( cutValue, static_cast<SignalBootstrap::Mode>( mode ), nPaths, blockLength, 0.95, 7, nThreads );
+					std::cout << std::setw(16) << ( mode == SignalBootstrap::BlockBootstrap ? "block" : "random entry" ) << std::setw(10) << res.nPositions
+						  << std::setw(10) << res.roi << std::setw(12) << res.roiCI.lower << std::setw(12) << res.roiCI.upper
+						  << std::setw(10) << res.maxdd << std::setw(12) << res.maxddCI.lower << std::setw(12) << res.maxddCI.upper
+						  << std::setw(10);
+					// Block paths resample the strategy's own trades, only random entries give a p-value
+					if( std::isnan( res.pValue ) ) std::cout << "-"; else std::cout << res.pValue;
+					std::cout << std::endl;
+				}
+				return 0;
+			}
+
+			if( vm.count("scan") ) {
+				MVABacktester scanner( spx_db, app, mvaMethod );
+				scanner.setScores( scores );
+				const std::vector<ScanResult> scan = scanner.scan( cuts, dayshift, define_type );
+
+				if( sink ) {
+					ReportTable table( "cut_scan" );
+					for( std::vector<ScanResult>::const_iterator it = scan.begin(); it != scan.end(); ++it ) {
+						table.add_row();
+						table.set( "cut", it->cut );
+						table.set( "trades", it->nPositions );
+						table.set( "roi", it->roi );
+						table.set( "avg", it->avg );
+						table.set( "stddev", it->stddev );
+						table.set( "skew", it->skew );
+						table.set( "maxdd", it->maxdd );
+					}
+					sink->write( table );
+					return 0;
+				}
+
+				Report::header("Cut scan");
+				std::cout << std::setw(10) << "Cut" << std::setw(10) << "Trades" << std::setw(10) << "ROI" << std::setw(10) << "Avg"
+					  << std::setw(10) << "StdDev" << std::setw(10) << "Skew" << std::setw(10) << "MaxDD" << std::endl;
+				for( std::vector<ScanResult>::const_iterator it = scan.begin(); it != scan.end(); ++it ) {
+					std::cout << std::setw(10) << it->cut << std::setw(10) << it->nPositions << std::setw(10) << it->roi << std::setw(10) << it->avg
+						  << std::setw(10) << it->stddev << std::setw(10) << it->skew << std::setw(10) << it->maxdd << std::endl;
+				}
+				return 0;
+			}
+
+			if( N > 1 ) {
+				sweep.run( cuts, seeds, dayshift, define_type, nThreads );
+				results = sweep.results();
+
+				if( sink ) {
+					sink->write( sweep.table() );
+				} else {
+					Report::header("Cut scan");
+					sweep.print();
+				}
+			}
+
+			for( std::vector<CutResult>::const_iterator it = results.begin(); it != results.end(); ++it ) {
+				treeWriter.column( "mvaCutValue", it->cut );
+				treeWriter.column( "SHARPE", it->sharpe );
+				treeWriter.column( "ROIEOM", it->roiEOM );
+				treeWriter.column( "CAGR", it->cagr );
+				treeWriter.column( "GSDM", it->gsdm );
+				treeWriter.column( "MAXDD", it->maxdd );
+				treeWriter.column( "ROI", it->roi );
+				treeWriter.column( "STDDEV", it->stddev );
+				treeWriter.column( "SKEW", it->skew );
+				treeWriter.column( "AVE", it->avg );
+				treeWriter.column( "nPositions", it->nPositions );
+				treeWriter.write();
 			}
 		}
 
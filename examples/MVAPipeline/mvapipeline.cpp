@@ -0,0 +1,317 @@
+// Indicators, training, scoring and backtest in one process, without intermediate files.
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <set>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <algorithm>
+
+// Boost
+#include <boost/program_options.hpp>
+
+// include local
+#include "DefinedMVAs.hpp"
+#include "MVABacktester.hpp"
+#include "MVAPipeline.hpp"
+#include "MVAScheduler.hpp"
+#include "WalkForward.hpp"
+
+// Hudson
+#include <Database.hpp>
+#include <EODSeries.hpp>
+#include <IndicatorApp.hpp>
+#include <EOMReturnFactors.hpp>
+#include <EOMReport.hpp>
+#include <PortfolioOptimizer.hpp>
+#include <PortfolioReport.hpp>
+#include <ReturnFactors.hpp>
+#include <Report.hpp>
+
+using namespace std;
+using namespace boost::gregorian;
+using namespace Series;
+
+namespace po = boost::program_options;
+
+
+// The indicators the MVAs are trained on, the same for every asset.
+void addIndicators( IndicatorApp& app ) {
+
+	app.addIndicator( "EMA", 14 );
+	app.addIndicator( "SMA", 7 );
+	app.addIndicator( "MFI", 7 );
+	app.addIndicator( "WILLR", 7 );
+	app.addIndicator( "RSI", 7 );
+	app.addIndicator( "MOM", 7 );
+	app.addIndicator( "ROCP", 7 );
+	app.addIndicator( "GTND", 3 );
+	app.addIndicator( "CCI", 7 );
+	app.addIndicator( "BOP" );
+	app.addIndicator( "ADX", 7 );
+	app.addIndicator( "STDDEV", 7, 3.5 );
+	app.addIndicator( "VAR", 7, 10.0 );
+	app.addIndicator( "APO", 5, 7 );
+	app.addIndicator( "ADO", 5, 7 );
+	app.addIndicator( "ADOSC", 5, 7 );
+	app.addIndicator( "CMO", 7 );
+	app.addIndicator( "LSLR", 7 );
+	app.addIndicator( "LSLR_C", 7 );
+	app.addIndicator( "LSLR_M", 7 );
+	app.addIndicator( "MACD", 7, 12, 26 );
+	app.addIndicator( "STOCHRSI", 12, 3, 5 );
+	app.addIndicator( "BBANDS", 7, 3.0, 3.0 );
+	app.addHTIT();
+	app.addHTDCP();
+	app.initialise();
+}
+
+
+int main(int argc, const char* argv[]) {
+
+	std::string begin_date, end_date, split_date;
+	std::string spx_dbfile;
+	std::string weightsDir("weights"), tupleFile;
+	std::vector<std::string> addmvas, inputvars;
+	std::string backtestmva, optimise;
+	Float_t cutValue = 0.1;
+	std::vector<std::string> assets;
+	int dayshift = 7, type(0);
+	unsigned nJobs(0), trainMonths(0), testMonths(12);
+
+	/*
+	 * Extract simulation options
+	 */
+	po::options_description desc("Allowed options");
+	desc.add_options()
+		("help", "produce help message")
+		("spx_file",   po::value<string>(&spx_dbfile),     "SPX series database.")
+		("begin_date", po::value<string>(&begin_date),     "start of training period (YYYY-MM-DD).")
+		("split_date", po::value<string>(&split_date),     "end of training and start of trading period (YYYY-MM-DD).")
+		("end_date",   po::value<string>(&end_date),       "end of trading period (YYYY-MM-DD).")
+		("mva",        po::value< std::vector<std::string> >(&addmvas)->multitoken(), "the mva methods to train (BDTD).")
+		("mva_type",   po::value<string>(&backtestmva),    "the mva to backtest, the first trained one by default.")
+		("var",        po::value< std::vector<std::string> >(&inputvars)->multitoken(), "specify the training variables to use.")
+		("cut_value",  po::value<Float_t>(&cutValue),      "the minimum mva cut value in which to buy an asset.")
+		("cut_type",   po::value<int>(&type),	           "set the mva cut type where it is standard (0), random (1) or a probability transfrom between 0-1 (2).")
+		("day_shift",  po::value<int>(&dayshift),          "time period (day shift) for calculating signal and background weights (7).")
+		("weights_dir", po::value<string>(&weightsDir),    "directory for the trained weight files (weights).")
+		("tuple_file", po::value<string>(&tupleFile),      "optionally write the features, labels and scores to this root file.")
+		("asset",      po::value< std::vector<std::string> >(&assets)->multitoken(), "further SYMBOL=file series to trade with the SPX trained mva as a portfolio.")
+		("jobs,j",     po::value<unsigned>(&nJobs),        "number of concurrent portfolio backtests or walk-forward trainings, all cores by default.")
+		("train_months", po::value<unsigned>(&trainMonths), "walk forward from begin to end date with training windows of this many months instead of one split.")
+		("test_months", po::value<unsigned>(&testMonths),  "walk-forward test window and step in months (12).")
+		("anchored",                                       "walk-forward training windows all start at the begin date.")
+		("optimise",   po::value<string>(&optimise),       "optimise the portfolio weights for sharpe, minvar or parity.")
+		;
+
+	po::variables_map vm;
+	po::store(po::parse_command_line(argc, argv, desc), vm);
+	po::notify(vm);
+
+	if( vm.count("help") ) {
+		cout << desc << endl;
+		exit(0);
+	}
+
+	if( vm["spx_file"].empty() || vm["begin_date"].empty() ||
+			( vm["split_date"].empty() && trainMonths == 0 ) || vm["end_date"].empty() ) {
+		cout << desc << endl;
+		exit(1);
+	}
+
+	date load_begin(from_simple_string(begin_date));
+	date load_split = trainMonths ? date(not_a_date_time) : from_simple_string(split_date);
+	date load_end(from_simple_string(end_date));
+	if( load_begin.is_not_a_date() || ( trainMonths == 0 && load_split.is_not_a_date() ) || load_end.is_not_a_date() ) {
+		cerr << "Invalid begin, split or end date" << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	if( addmvas.empty() ) addmvas.push_back("BDTD");
+	if( backtestmva.empty() ) backtestmva = addmvas.front();
+	if( inputvars.empty() ) {
+		inputvars.push_back("BOP");
+		inputvars.push_back("APO");
+		inputvars.push_back("STDDEV");
+		inputvars.push_back("CCI");
+		inputvars.push_back("ADO");
+		inputvars.push_back("ADX");
+		inputvars.push_back("MACD_signal");
+	}
+
+	try {
+		/*
+		 * Load series data
+		 */
+		const string spx_symbol = "SPX";
+		std::cout << "Loading " << spx_dbfile << " from " << load_begin << " to " << load_end << "..." << std::endl;
+		Series::EODDB::instance().load(spx_symbol, spx_dbfile, Series::EODDB::YAHOO, load_begin, load_end);
+		const Series::EODSeries& spx_db = Series::EODDB::instance().get( spx_symbol );
+
+		std::set< std::pair< std::string, std::string > > leaves;
+		leaves.insert( std::make_pair( "SMA", "" ) );
+		leaves.insert( std::make_pair( "EMA", "" ) );
+		leaves.insert( std::make_pair( "MFI", "" ) );
+		leaves.insert( std::make_pair( "BOP", "" ) );
+		leaves.insert( std::make_pair( "ADOSC", "" ) );
+		leaves.insert( std::make_pair( "APO", "" ) );
+		leaves.insert( std::make_pair( "VAR", "" ) );
+		leaves.insert( std::make_pair( "WILLR", "" ) );
+		leaves.insert( std::make_pair( "STDDEV", "" ) );
+		leaves.insert( std::make_pair( "CCI", "" ) );
+		leaves.insert( std::make_pair( "ADO", "" ) );
+		leaves.insert( std::make_pair( "ADX", "" ) );
+		leaves.insert( std::make_pair( "GTND", "" ) );
+		leaves.insert( std::make_pair( "LSLR", "" ) );
+		leaves.insert( std::make_pair( "LSLR_C", "" ) );
+		leaves.insert( std::make_pair( "LSLR_M", "" ) );
+		leaves.insert( std::make_pair( "RSI", "" ) );
+		leaves.insert( std::make_pair( "HTIT", "" ) );
+		leaves.insert( std::make_pair( "HTDCP", "" ) );
+		leaves.insert( std::make_pair( "MACD", "" ) );
+		leaves.insert( std::make_pair( "MACD", "signal" ) );
+		leaves.insert( std::make_pair( "MACD", "hist" ) );
+		leaves.insert( std::make_pair( "STOCHRSI", "D" ) );
+		leaves.insert( std::make_pair( "STOCHRSI", "K" ) );
+		leaves.insert( std::make_pair( "BBANDS", "upper" ) );
+		leaves.insert( std::make_pair( "BBANDS", "middle" ) );
+		leaves.insert( std::make_pair( "BBANDS", "lower" ) );
+
+		IndicatorApp app( spx_db );
+		addIndicators( app );
+
+		if( trainMonths ) {
+			/*
+			 * Retrain on sliding windows and trade every test window with its own weights
+			 */
+			MVAPipeline pipeline( spx_db, app, leaves, dayshift );
+			pipeline.initialise();
+
+			WalkForward walk( spx_db, app, pipeline );
+			walk.setFolds( load_begin, load_end, trainMonths, testMonths, vm.count("anchored") );
+			if( !walk.train( std::vector<std::string>( 1, backtestmva ), inputvars, nJobs ? nJobs : std::max( std::thread::hardware_concurrency(), 1u ) ) )
+				cerr << "Some walk-forward folds failed to train, their test windows are not traded" << endl;
+			walk.score( backtestmva, inputvars );
+			walk.backtest( backtestmva, cutValue, static_cast<MVABacktester::Type>( type ) );
+
+			Report::header("Walk Forward Folds");
+			walk.print();
+
+			Report::header("SPX Out Of Sample Stats");
+			EOMReturnFactors oos_eomrf( walk.positions(), walk.period().begin(), walk.period().last() );
+			EOMReport oos_eomrp( oos_eomrf );
+			oos_eomrp.print();
+
+			ReturnFactors oos_rf( walk.positions() );
+			Report oos_rp( oos_rf );
+			oos_rp.print();
+			return 0;
+		}
+
+		/*
+		 * Train on the bars before the split date, whose labels end before it, and score everything
+		 */
+		MVAPipeline pipeline( spx_db, app, leaves, dayshift );
+		pipeline.initialise();
+
+		const EODSeries::const_iterator last_train = spx_db.before( load_split, dayshift + 1 );
+		const date train_end = last_train != spx_db.end() ? last_train->first : load_begin;
+		if( !pipeline.train( addmvas, inputvars, date_period( load_begin, train_end ), "TMVA.root", weightsDir ) ) {
+			cerr << "Training failed" << endl;
+			exit(EXIT_FAILURE);
+		}
+
+		boost::shared_ptr< const std::vector<Float_t> > scores;
+		for( std::vector<std::string>::const_iterator it = addmvas.begin(); it != addmvas.end(); ++it ) {
+			boost::shared_ptr< const std::vector<Float_t> > mvaScores = pipeline.score( *it, inputvars, weightsDir );
+			if( *it == backtestmva ) scores = mvaScores;
+		}
+		if( !scores ) scores = pipeline.score( backtestmva, inputvars, weightsDir );
+		if( !tupleFile.empty() ) pipeline.writeTuple( tupleFile );
+
+		/*
+		 * Trade the remaining bars on the stored scores
+		 */
+		MVABacktester backtester( spx_db, app, backtestmva, cutValue );
+		backtester.setLedger();
+		backtester.setScores( scores );
+		backtester.setPeriod( date_period( load_split, load_end ) );
+		backtester.run( dayshift, static_cast<MVABacktester::Type>( type ) );
+
+		Report::header("SPX Stats");
+		EOMReturnFactors spx_eomrf2( backtester.positions("SPX"), load_split, load_end );
+		EOMReport eomrp(spx_eomrf2);
+		eomrp.print();
+
+		ReturnFactors spx_eomrf( backtester.positions() );
+		Report rp(spx_eomrf);
+		rp.print();
+
+		if( assets.empty() ) return 0;
+
+		/*
+		 * Score every further asset with the same weights and backtest all of them, SPX included, at once
+		 */
+		MVAScheduler scheduler( load_split, load_end );
+		MVAJob job;
+		job.mva = backtestmva;
+		job.cut = cutValue;
+		job.dayshift = dayshift;
+		job.type = static_cast<MVABacktester::Type>( type );
+
+		job.symbol = spx_symbol;
+		job.app = &app;
+		job.scores = scores;
+		scheduler.add( job );
+
+		std::vector< std::shared_ptr<IndicatorApp> > apps;
+		for( std::vector<std::string>::const_iterator it = assets.begin(); it != assets.end(); ++it ) {
+
+			const std::string::size_type eq = it->find( '=' );
+			if( eq == std::string::npos ) {
+				cerr << "Invalid asset " << *it << ", expected SYMBOL=file" << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			job.symbol = it->substr( 0, eq );
+			std::cout << "Loading " << it->substr( eq + 1 ) << " from " << load_begin << " to " << load_end << "..." << std::endl;
+			Series::EODDB::instance().load( job.symbol, it->substr( eq + 1 ), Series::EODDB::YAHOO, load_begin, load_end );
+			const Series::EODSeries& db = Series::EODDB::instance().get( job.symbol );
+
+			apps.push_back( std::make_shared<IndicatorApp>( db ) );
+			addIndicators( *apps.back() );
+
+			MVAPipeline assetPipeline( db, *apps.back(), leaves, dayshift );
+			assetPipeline.initialise();
+
+			job.app = apps.back().get();
+			job.scores = assetPipeline.score( backtestmva, inputvars, weightsDir );
+			scheduler.add( job );
+		}
+
+		Report::header("Portfolio Stats");
+		scheduler.run( nJobs );
+		scheduler.print();
+
+		if( optimise.empty() ) return 0;
+
+		Report::header("Optimised Portfolio Stats");
+		PortfolioReturns pr = scheduler.portfolio();
+		PortfolioOptimizer optimizer( pr );
+		optimizer.optimize( PortfolioOptimizer::objective_from_str( optimise ), 16, nJobs );
+		optimizer.apply( pr );
+
+		PortfolioReport prp( pr );
+		prp.weights();
+		prp.print();
+
+	} catch( std::exception& ex ) {
+
+		std::cerr << "Unhandled exception: " << ex.what() << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	return 0;
+}
@@ -0,0 +1,157 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _DAILYEQUITY_HPP_
+#define _DAILYEQUITY_HPP_
+
+#ifdef WIN32
+#pragma warning (disable:4290)
+#endif
+
+// STL
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/date_time/gregorian/gregorian.hpp>
+
+// Hudson
+#include "EODDB.hpp"
+#include "PositionSet.hpp"
+#include "PortfolioReturns.hpp"
+
+
+class DailyEquityException: public std::exception
+{
+public:
+  DailyEquityException(const std::string& msg):
+    _Str("DailyEquityException: ")
+  {
+    _Str += msg;
+  }
+
+  virtual ~DailyEquityException(void) throw() { }
+  virtual const char *what(void) const throw() { return _Str.c_str(); }
+
+protected:
+  std::string _Str;
+};
+
+
+//! Daily net asset value of one or more position sets.
+/*!
+  DailyEquity marks every position to market on each trading day between begin and end and
+  compounds the result into a daily NAV curve starting at 1. Prices of all symbols involved are
+  aligned once on a common calendar, the union of their trading days, and each position then only
+  reads consecutive entries of its symbol array.
+
+  Positions of a PositionSet form a sleeve. The sleeve daily factor is the product of the daily
+  factors of the positions held that day, or the daily risk-free rate when nothing is held, as in
+  EOMReturnFactors. A PortfolioReturns is handled as one sleeve per EOMReturnFactors, rebalanced
+  daily to its portfolio weight. StrategyPosition legs are combined as 1 + sum(weight * (f - 1)).
+
+  Daily factors of a position run from its first execution date close to the close of its last
+  execution date, or to end if the position is still open, like Position::factors().
+  \see EOMReturnFactors.
+  \see PortfolioReturns.
+*/
+class DailyEquity
+{
+public:
+  /*!
+    \param sPositions Positions to mark to market, any number of symbols.
+    \param begin First day of the equity curve.
+    \param end Last day of the equity curve.
+    \param rf_rate Fixed annual risk-free rate in percent, earned on cash days and used by sharpe()/sortino().
+    \param pt Price type used to mark positions.
+  */
+  DailyEquity(const PositionSet& sPositions, const boost::gregorian::date& begin, const boost::gregorian::date& end,
+              double rf_rate = 3.0, Series::EODDB::PriceType pt = Series::EODDB::ADJCLOSE) throw(DailyEquityException);
+  //! Equity curve of a portfolio, one sleeve per EOMReturnFactors with its portfolio weight.
+  DailyEquity(const PortfolioReturns& pr, const boost::gregorian::date& begin, const boost::gregorian::date& end,
+              double rf_rate = 3.0, Series::EODDB::PriceType pt = Series::EODDB::ADJCLOSE) throw(DailyEquityException);
+
+  //! Trading days of the equity curve.
+  const std::vector<boost::gregorian::date>& dates(void) const { return _vDates; }
+  //! Net asset value on each of dates(), starting at 1.
+  const std::vector<double>& nav(void) const { return _vNAV; }
+  //! Portfolio factor from the previous day to each of dates(). The first entry is 1.
+  const std::vector<double>& factors(void) const { return _vFactors; }
+
+  //! Returns the return on investment over the whole curve.
+  double roi(void) const;
+  //! Returns the annualized standard deviation of daily returns.
+  double volatility(void) const;
+  //! Returns the annualized Sharpe ratio of daily returns.
+  double sharpe(void) const;
+  //! Returns the annualized Sortino ratio, using daily returns below the risk-free rate as downside.
+  double sortino(void) const;
+  //! Returns the deepest decline from a NAV peak, as a negative fraction of the peak.
+  double dd(void) const { return _dd; }
+  //! Returns the period from the NAV peak to the bottom of dd().
+  boost::gregorian::date_period dd_period(void) const { return _dd_period; }
+
+  //! Trading days per year used to annualize daily statistics.
+  static const int TRADING_DAYS = 252;
+
+protected:
+  struct Sleeve
+  {
+    Sleeve(const PositionSet* pPositions_, double w_);
+
+    const PositionSet* pPositions;
+    double w;
+  };
+
+  typedef std::vector<double> doubleVector;
+  typedef std::map<std::string, doubleVector> SYMBOL_PRICES;
+
+  void _calculate(void) throw(DailyEquityException);
+  //! Union of the trading days of all symbols between _begin and _end.
+  void _calendar(void) throw(DailyEquityException);
+  //! Prices of pPos symbol aligned on the calendar, NaN before the first record.
+  const doubleVector& _prices(const PositionPtr pPos) throw(DailyEquityException);
+  //! Calendar rows [first, last] held by a Long/Short position. Returns false if it has no daily factor in the curve.
+  bool _span(const PositionPtr pPos, std::size_t& first, std::size_t& last) const throw(DailyEquityException);
+  //! Multiply the daily factors of pPos into acc and flag the days it is held.
+  void _mark(const PositionPtr pPos, doubleVector& acc, std::vector<bool>& held) throw(DailyEquityException);
+
+protected:
+  const boost::gregorian::date _begin;
+  const boost::gregorian::date _end;
+  const double _rf_rate;
+  const Series::EODDB::PriceType _pt;
+
+  std::vector<Sleeve> _vSleeves;
+  SYMBOL_PRICES _mPrices;         // symbol prices aligned on _vDates
+
+  std::vector<boost::gregorian::date> _vDates;
+  doubleVector _vNAV;
+  doubleVector _vFactors;
+
+  double _mean;                   // daily returns average
+  double _stddev;                 // daily returns standard deviation
+  double _downside;               // daily downside deviation from the risk-free rate
+  double _dd;
+  boost::gregorian::date_period _dd_period;
+};
+
+#endif // _DAILYEQUITY_HPP_
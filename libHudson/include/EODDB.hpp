@@ -25,6 +25,7 @@
 // STL
 #include <map>
 #include <string>
+#include <vector>
 #include <stdexcept>
 #include <memory>
 
@@ -74,6 +75,9 @@ namespace Series
       ADJCLOSE
     };
 
+    //! Integer handle of a loaded series, assigned in load order.
+    typedef std::size_t SeriesID;
+
   public:
     static EODDB& instance(void);
 
@@ -81,6 +85,11 @@ namespace Series
 	            const boost::gregorian::date& begin, const boost::gregorian::date& end) throw(EODDBException);
     const EODSeries& get(const std::string& name) const throw(EODDBException);
 
+    //! Return the id of a loaded series. Resolve it once and use get(SeriesID) in loops.
+    SeriesID id(const std::string& name) const throw(EODDBException);
+    //! Return a loaded series by id, an array lookup.
+    const EODSeries& get(SeriesID id) const throw(EODDBException);
+
   protected:
     EODDB(void) { }
 
@@ -89,8 +98,9 @@ namespace Series
     GoogleTrendDriver _gtd;
     DMYCloseDriver _dmycd;
 
-    typedef std::map<std::string, EODSeries*> DB;
+    typedef std::map<std::string, SeriesID> DB;
     DB _sDB;
+    std::vector<EODSeries*> _vSeries;
 
   private:
     static std::auto_ptr<EODDB> _pInstance;
@@ -262,9 +262,44 @@ namespace Series
     //! Return last EOD record in series.
     Series::DayPrice last(void) const { return (*rbegin()).second; }
 
+    //! Dates of all loaded records in time order. Row i of the price columns belongs to dates()[i].
+    /*!
+      The date and price columns are filled by load(). They are a contiguous copy of the map
+      for linear scans and load() is the only supported way to change a series: records
+      inserted, erased or edited in the map directly leave the columns stale.
+      \see hasColumns().
+    */
+    const std::vector<boost::gregorian::date>& dates(void) const { return _vDates; }
+    //! Open prices of all loaded records, same rows as dates().
+    const std::vector<double>& openColumn(void) const { return _vOpen; }
+    //! Close prices of all loaded records, same rows as dates().
+    const std::vector<double>& closeColumn(void) const { return _vClose; }
+    //! Adjusted close prices of all loaded records, same rows as dates().
+    const std::vector<double>& adjcloseColumn(void) const { return _vAdjClose; }
+    //! True if the columns hold as many records as the map.
+    /*!
+      Only the sizes are compared, so in place edits of the map are not detected.
+      \see dates().
+    */
+    bool hasColumns(void) const { return _vDates.size() == ThisMap::size(); }
+    //! Column row of the record on dt, npos if there is none.
+    std::size_t row(const boost::gregorian::date& dt) const;
+    //! Column row of the last record on or before dt, npos if there is none.
+    std::size_t row_at_or_before(const boost::gregorian::date& dt) const;
+
+    static const std::size_t npos;
+
+  private:
+    void _buildColumns(void);
+
   private:
     std::string _name;
     bool _isLoaded;
+
+    std::vector<boost::gregorian::date> _vDates;
+    std::vector<double> _vOpen;
+    std::vector<double> _vClose;
+    std::vector<double> _vAdjClose;
   };
 
 } // namespace Series
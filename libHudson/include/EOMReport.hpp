@@ -46,6 +46,8 @@ public:
 
   //! Print all EOMReport statistics.
   void print(void) const;
+  //! Set all EOMReport statistics in the last row of table. \see Report::fill().
+  void fill(ReportTable& table, const std::string& prefix = "") const;
 
 private:
   const EOMReturnFactors& _eomrf;
@@ -28,6 +28,7 @@
 #include <cmath>
 
 // STL
+#include <map>
 #include <vector>
 #include <functional>
 
@@ -64,6 +65,13 @@ public:
   //! Returns sharpe ratio.
   double sharpe(void) const;
 
+  typedef std::map<boost::gregorian::date, double> DATEMFACTOR;
+
+  //! Returns monthly factors by end-of-month date.
+  const DATEMFACTOR& mfactors(void) const { return _mDateMFactors; }
+  //! Returns the risk-free rate used to calculate Sharpe ratio.
+  double rf_rate(void) const { return _rf_rate; }
+
 protected:
   void _calculateM2M(void);
 
@@ -75,7 +83,6 @@ protected:
   std::vector<double> _vMFactors; // monthly factors
   std::vector<double> _vLogMFactors; // monthly log factors
 
-  typedef std::map<boost::gregorian::date, double> DATEMFACTOR;
   DATEMFACTOR _mDateMFactors;
 
   double _mmean;
@@ -89,6 +96,10 @@ protected:
   struct log10_uf: public std::unary_function<double, double> {
     double operator()(double x) { return ::log10(x); }
   };
+
+  struct PositionOpenCmp: public std::binary_function<PositionPtr, PositionPtr, bool> {
+    bool operator()(const PositionPtr pos1, const PositionPtr pos2) const { return pos1->first_exec()->dt() < pos2->first_exec()->dt(); }
+  };
 };
 
 
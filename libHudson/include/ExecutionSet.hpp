@@ -24,6 +24,9 @@
 #pragma warning (disable:4290)
 #endif
 
+// STL
+#include <atomic>
+
 // Boost
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/mem_fun.hpp>
@@ -91,8 +94,8 @@ public:
   void print(void) const;
 
 private:
-  //! Unique execution identifier
-  static Execution::ID _eid;
+  //! Unique execution identifier, shared by traders running in parallel
+  static std::atomic<Execution::ID> _eid;
 
 private:
   typedef __ExecutionSet::index<side_key>::type by_side;
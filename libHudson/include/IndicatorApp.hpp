@@ -135,10 +135,16 @@ class IndicatorApp {
     //template < class T >
     double evaluate( const std::string& indicator, const std::string& ext = "" );
 
+    // Same as evaluateAtOrBefore but leaves the current event untouched, safe to share.
+    double value( const std::string& indicator, const boost::gregorian::date& date, const std::string& ext = "" ) const ;
+    // Indicator value for every event from getStartIdx() to the end of the series.
+    std::vector< double > column( const std::string& indicator, const std::string& ext = "" ) const ;
+
     TA::vDouble getData( const IndicatorApp::DataType& type );
   private:
     // private member functions
     void updatePeriod( const int& period );
+    double lookup( const boost::gregorian::date& date, const std::string& indicator, const std::string& ext ) const ;
   
     // member variables
     const Series::EODSeries& m_db;
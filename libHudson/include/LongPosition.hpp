@@ -87,12 +87,12 @@ public:
   //! Add BuyExecution at specific price.
   virtual void buy(const boost::gregorian::date& dt, const Price& price, unsigned size) throw(PositionException);
   //! Add BuyExecution at database PriceType.
-  virtual void buy(const boost::gregorian::date& dt, Series::EODDB::PriceType pt, unsigned size) throw(PositionException) { buy(dt, Price::get(_symbol, dt, pt), size); }
+  virtual void buy(const boost::gregorian::date& dt, Series::EODDB::PriceType pt, unsigned size) throw(PositionException) { buy(dt, Price::get(series(), dt, pt), size); }
 
   //! Add SellExecution at specific price.
   virtual void sell(const boost::gregorian::date& dt, const Price& price, unsigned size) throw(PositionException);
   //! Add SellExecution at database PriceType.
-  virtual void sell(const boost::gregorian::date& dt, Series::EODDB::PriceType pt, unsigned size) throw(PositionException) { sell(dt, Price::get(_symbol, dt, pt), size); }
+  virtual void sell(const boost::gregorian::date& dt, Series::EODDB::PriceType pt, unsigned size) throw(PositionException) { sell(dt, Price::get(series(), dt, pt), size); }
   
   //! Throw an exception. LongPosition can not be sold short.
   virtual void sell_short(const boost::gregorian::date& dt, const Price& price, unsigned size) throw(PositionException);
@@ -107,7 +107,7 @@ public:
   //! Close any open size by adding a SellExecution (s).
   virtual void close(const boost::gregorian::date& dt, const Price& price) throw(PositionException);
   //! Close any open size on dt at PriceType.
-  virtual void close(const boost::gregorian::date& dt, Series::EODDB::PriceType pt) throw(PositionException) { close(dt, Price::get(_symbol, dt, pt)); }
+  virtual void close(const boost::gregorian::date& dt, Series::EODDB::PriceType pt) throw(PositionException) { close(dt, Price::get(series(), dt, pt)); }
 
 private:
   unsigned _buys;
@@ -0,0 +1,76 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _ONLINERETURNFACTORS_HPP_
+#define _ONLINERETURNFACTORS_HPP_
+
+
+//! Running return factor statistics, updated with one Position factor at a time.
+/*!
+  OnlineReturnFactors keeps the statistics of ReturnFactors as running values, so adding a
+  factor is O(1) and no factor is stored. Mean and the second and third central moments are
+  updated with Welford's and Pebay's formulas. The compounded factor is kept as a direct product,
+  as ReturnFactors computes it, and the drawdown from the running peak of the sum of logs.
+  Factors must be added in time order for roi() and dd() to match ReturnFactors.
+  \see ReturnFactors.
+  \see Trader::stats().
+*/
+class OnlineReturnFactors
+{
+public:
+  OnlineReturnFactors(void);
+
+  //! Add the return factor of the next Position.
+  void add(double factor);
+  //! Remove all factors.
+  void clear(void);
+
+  //! Return the number of factors added.
+  int num(void) const { return (int)_n; }
+
+  //! Return the return on investment.
+  double roi(void) const;
+  //! Return the average factors return.
+  double avg(void) const { return _n ? _mean - 1 : 0; }
+  //! Return the factors return standard deviation.
+  double stddev(void) const;
+  //! Return the factors return skew.
+  double skew(void) const;
+
+  //! Return the highest factor added.
+  double best(void) const { return _best; }
+  //! Return the lowest factor added.
+  double worst(void) const { return _worst; }
+  //! Return the lowest compounded factor of consecutive positions, 1 if there is none below 1.
+  double dd(void) const;
+
+private:
+  unsigned long _n;
+  double _mean;        // factors average
+  double _m2;          // sum of squared deviations from the mean
+  double _m3;          // sum of cubed deviations from the mean
+  double _fvalue;      // compounded factor
+  double _log_fvalue;  // log of the compounded factor
+  double _log_peak;    // highest _log_fvalue before the last factor
+  double _log_dd;      // lowest _log_fvalue - _log_peak
+  double _best;
+  double _worst;
+};
+
+#endif // _ONLINERETURNFACTORS_HPP_
@@ -0,0 +1,132 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _PORTFOLIOOPTIMIZER_HPP_
+#define _PORTFOLIOOPTIMIZER_HPP_
+
+#ifdef WIN32
+#pragma warning (disable:4290)
+#endif
+
+// STL
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Hudson
+#include "PortfolioReturns.hpp"
+
+
+class PortfolioOptimizerException: public std::exception
+{
+public:
+  PortfolioOptimizerException(const std::string& msg):
+    _Str("PortfolioOptimizerException: ")
+  {
+    _Str += msg;
+  }
+
+  virtual ~PortfolioOptimizerException(void) throw() { }
+  virtual const char *what(void) const throw() { return _Str.c_str(); }
+
+protected:
+  std::string _Str;
+};
+
+
+//! Find PortfolioReturns component weights from their monthly returns.
+/*!
+  The average monthly returns and the covariance matrix of the components are read once from
+  PortfolioReturns. Weights are then found by projected gradient descent with backtracking, fully
+  invested and long only: each weight in the 0-1 range and summing to 1.
+
+  MAX_SHARPE and MIN_VARIANCE descend on the weights simplex. RISK_PARITY minimizes
+  1/2 y'Cy - 1/n sum(log y) over positive y and normalizes y to weights, which gives every
+  component the same contribution to the portfolio variance.
+
+  Each optimization is run from several starting weights, equal weights first and then random ones,
+  in parallel threads. The best result is kept, ties going to the earliest start, so the result
+  does not depend on the number of threads.
+  \see PortfolioReturns.
+*/
+class PortfolioOptimizer
+{
+public:
+  enum Objective {
+    MAX_SHARPE,
+    MIN_VARIANCE,
+    RISK_PARITY
+  };
+
+public:
+  /*!
+    \param pr Portfolio whose component returns are optimized. Must contain at least one component.
+  */
+  PortfolioOptimizer(const PortfolioReturns& pr) throw(PortfolioOptimizerException);
+
+  //! Optimize weights for obj.
+  /*!
+    \param nStarts Number of starting weights.
+    \param nThreads Number of threads running the starts, all cores if 0.
+    \param seed Seed of the random starting weights.
+    \return The best weights, in PortfolioReturns insertion order.
+  */
+  const std::vector<double>& optimize(Objective obj, unsigned nStarts = 16, unsigned nThreads = 0, unsigned long seed = 7);
+
+  //! Set the optimized weights in pr. pr must have the components this optimizer was built from.
+  void apply(PortfolioReturns& pr) const throw(PortfolioReturnsException) { pr.setWeights(_vWeights); }
+
+  //! Weights found by the last optimize().
+  const std::vector<double>& weights(void) const { return _vWeights; }
+  //! Objective value of weights().
+  double objective(void) const { return _objective; }
+
+  //! Monthly variance of the portfolio with weights w.
+  double variance(const std::vector<double>& w) const;
+  //! Annualized Sharpe ratio of the portfolio with weights w, as in PortfolioReturns::sharpe().
+  double sharpe(const std::vector<double>& w) const;
+
+  //! Objective name.
+  static std::string objective_str(Objective obj);
+  //! Objective from name: sharpe, minvar or parity.
+  static Objective objective_from_str(const std::string& name) throw(PortfolioOptimizerException);
+
+protected:
+  //! Objective value at x, gradient in grad.
+  double _value(Objective obj, const std::vector<double>& x, std::vector<double>& grad) const;
+  //! Feasible point closest to x.
+  void _project(Objective obj, std::vector<double>& x) const;
+  //! Projected gradient descent from x. Returns the objective value at the end point left in x.
+  double _descend(Objective obj, std::vector<double>& x) const;
+  //! Weights from a descent end point.
+  std::vector<double> _weights(Objective obj, const std::vector<double>& x) const;
+
+protected:
+  const std::size_t _n;
+  std::vector<double> _vMeans;      // component average monthly returns
+  std::vector<double> _vCovariance; // component monthly returns covariance, _n x _n by rows
+  double _rf_monthly;               // monthly risk-free rate
+
+  std::vector<double> _vWeights;
+  double _objective;
+
+  static const unsigned MAX_ITERATIONS = 5000;
+};
+
+#endif // _PORTFOLIOOPTIMIZER_HPP_
@@ -29,6 +29,7 @@
 
 // Hudson
 #include "PortfolioReturns.hpp"
+#include "ReportTable.hpp"
 
 
 /*!
@@ -49,6 +50,11 @@ public:
   void gsd(void)  const { std::cout << "GSDm: " << _pr.gsd()*100 << '%' << std::endl; }
   //! Prints Sharpe ratio.
   void sharpe(void) const { std::cout << "Sharpe: " << _pr.sharpe() << std::endl; }
+  //! Prints the weight of each component.
+  void weights(void) const;
+
+  //! Set roi, cagr, gsdm, sharpe and one weight_<i> column per component in the last row of table.
+  void fill(ReportTable& table, const std::string& prefix = "") const;
   
 protected:
   const PortfolioReturns& _pr;
@@ -27,6 +27,9 @@
 // STL
 #include <vector>
 
+// Boost
+#include <boost/date_time/gregorian/gregorian.hpp>
+
 // Hudson
 #include "EOMReturnFactors.hpp"
 
@@ -48,6 +51,12 @@ protected:
 
 
 //! Aggregate EOMReturns for multiple securities and calculate Portfolio statistics.
+/*!
+  The monthly factors of all EOMReturnFactors are aligned on the union of their end-of-month dates
+  into a components x months return matrix. Portfolio statistics are computed from the weighted sum
+  of the matrix rows, that is from a portfolio rebalanced monthly to the component weights. Months
+  missing from a component and any weight not allocated are flat.
+*/
 class PortfolioReturns
 {
 public:
@@ -59,7 +68,7 @@ public:
   double cagr(void) const;
   //! Returns Geometric Standard Deviation of Monthly Returns.
   double gsd(void) const;
-  //! Returns Sharpe Ratio
+  //! Returns Sharpe Ratio, using the risk-free rate of the first EOMReturnFactors.
   double sharpe(void) const;
   
   //! Add EOMReturnFactors for a specific symbol.
@@ -74,6 +83,31 @@ public:
   
   //! Returns the number of EOMReturnFactors included in this PortfolioReturns.
   unsigned series(void) const { return (unsigned)_vRF.size(); }
+  //! Returns the i-th EOMReturnFactors.
+  const EOMReturnFactors& returns(unsigned i) const { return *_vRF.at(i).pEOMRF; }
+  //! Returns the weight of the i-th EOMReturnFactors, 1/series() if all weights are 0.
+  double weight(unsigned i) const { return _accWeight ? _vRF.at(i).w : 1.0 / _vRF.size(); }
+
+  //! Replace the weights of all EOMReturnFactors, in insertion order.
+  /*!
+    Only the weighted sum of the return matrix is recomputed, component factors are not.
+    Weights follow the add() rules: each in the 0-1 range, summing to 1 at most, all 0 for equal weights.
+  */
+  void setWeights(const std::vector<double>& weights) throw(PortfolioReturnsException);
+
+  //! End-of-month dates of the return matrix.
+  const std::vector<boost::gregorian::date>& months(void) const { return _vMonths; }
+  //! Monthly return (factor - 1) of the i-th EOMReturnFactors in month m.
+  double monthly(unsigned i, std::size_t m) const { return _vReturns[i * _vMonths.size() + m]; }
+  //! Returns portfolio monthly factors at the current weights.
+  const std::vector<double>& mfactors(void) const { return _vMFactors; }
+  //! Returns average monthly return of each EOMReturnFactors.
+  const std::vector<double>& means(void) const;
+  //! Returns covariance matrix of the monthly returns, series() x series() by rows.
+  /*!
+    Computed on first use and cached until the next add(). Not affected by weights.
+  */
+  const std::vector<double>& covariance(void) const;
   
 protected:
   struct EOMRFWeight
@@ -83,9 +117,26 @@ protected:
     EOMReturnFactors* pEOMRF;
     double w;
   };
+
+  //! Align all monthly factors on the union of their months.
+  void _buildMatrix(void);
+  //! Portfolio monthly factors and statistics at the current weights.
+  void _aggregate(void);
   
   std::vector<EOMRFWeight> _vRF;
   double _accWeight;
+
+  std::vector<boost::gregorian::date> _vMonths;
+  std::vector<double> _vReturns;            // monthly returns, one row of months() per component
+  std::vector<double> _vMFactors;           // portfolio monthly factors
+
+  mutable std::vector<double> _vMeans;      // cached component average monthly returns
+  mutable std::vector<double> _vCovariance; // cached covariance matrix
+
+  double _fvalue;
+  double _mmean;
+  double _mstddev;
+  double _lfstddev;
 };
 
 #endif // _PORTFOLIORETURNS_HPP_
@@ -83,6 +83,8 @@ public:
   ID id(void) const { return _id; }
   //! Returns Position security ticker.
   std::string symbol(void) const { return _symbol; }
+  //! Returns the database series of symbol, looked up once and then kept.
+  const Series::EODSeries& series(void) const;
   //! Returns current open size.
   int size(void) const { return _size; }
 
@@ -172,9 +174,20 @@ public:
 protected:
   Position(ID id, const std::string& symbol);
 
+  /*!
+  \brief Daily factors over dp in a single pass on the series price column.
+  Stops at the closing execution if the Position is closed.
+  \param inverse Use begin/end price ratios, as for short positions, instead of end/begin.
+  */
+  SeriesFactorSet daily_factors(const boost::gregorian::date_period& dp, Series::EODDB::PriceType pt, bool inverse) const throw(PositionException);
+
+  //! Price of the last series record on or before a month mark, looked up by column row.
+  double mark_price(const boost::gregorian::date& mark, Series::EODDB::PriceType pt) const throw(PositionException);
+
   const ID _id;
   const std::string _symbol;
   unsigned _size;
+  mutable const Series::EODSeries* _pSeries; //! Series handle, resolved on first price lookup
 
   ExecutionSet _sExecutions;
 };
@@ -0,0 +1,120 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _POSITIONFACTORCACHE_HPP_
+#define _POSITIONFACTORCACHE_HPP_
+
+#ifdef WIN32
+#pragma warning (disable:4290)
+#endif
+
+// STL
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Boost
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+// Hudson
+#include "EODDB.hpp"
+#include "ExecutionObserver.hpp"
+#include "Position.hpp"
+#include "SeriesFactor.hpp"
+
+
+//! Daily Position factors, computed once per Position and PriceType.
+/*!
+  Position::factors() derives every daily factor from the EODDB series on each call. Reports
+  on the same positions (PositionFactors, PositionFactorsSet and PositionsReport) read them from
+  this cache instead, as contiguous arrays in to_tm order.
+
+  Entries are keyed by Position::ID and PriceType. Trader assigns position ids from one process
+  wide counter, so positions of different backtests never share an entry. A cached LONG or SHORT
+  position is watched through its ExecutionObserver hook and its factors are dropped on the next
+  execution. StrategyPosition does not accept observers, it invalidates its own entry when one of
+  its legs executes or a leg is added.
+
+  All methods are thread safe. The cache only keeps weak references to the positions, entries of
+  destroyed positions are pruned as new ones are added.
+  \see PositionFactors.
+*/
+class PositionFactorCache
+{
+public:
+  //! Daily factors in to_tm order, one per to_tm date.
+  typedef std::vector<SeriesFactor> FACTORS;
+  typedef boost::shared_ptr<const FACTORS> FactorsPtr;
+
+public:
+  ~PositionFactorCache(void);
+
+  static PositionFactorCache& instance(void);
+
+  //! Daily factors of pPos over its holding period, computed on the first request.
+  FactorsPtr factors(const PositionPtr& pPos, Series::EODDB::PriceType pt = Series::EODDB::ADJCLOSE) throw(PositionException);
+
+  //! Drop the cached factors of Position id.
+  void invalidate(Position::ID id);
+  //! Drop all entries and stop watching their positions. Must not run while cached positions trade.
+  void clear(void);
+
+  //! Number of cached positions.
+  std::size_t size(void) const;
+
+private:
+  PositionFactorCache(void);
+  PositionFactorCache(const PositionFactorCache&);
+  PositionFactorCache& operator=(const PositionFactorCache&);
+
+  //! Invalidates one Position entry on every new execution.
+  class Watch: public ExecutionObserver
+  {
+  public:
+    Watch(PositionFactorCache& cache, Position::ID id): _cache(cache), _id(id) { }
+    virtual void update(const ExecutionPtr /*pExe*/) { _cache.invalidate(_id); }
+
+  private:
+    PositionFactorCache& _cache;
+    const Position::ID _id;
+  };
+
+  struct Entry
+  {
+    Entry(void): generation(0) { }
+
+    unsigned long generation; // bumped on every invalidation
+    boost::weak_ptr<Position> wpPos;
+    boost::shared_ptr<Watch> pWatch; // null for StrategyPosition
+    std::map<Series::EODDB::PriceType, FactorsPtr> mFactors;
+  };
+
+  typedef std::map<Position::ID, Entry> ENTRIES;
+
+  //! Remove entries of destroyed positions.
+  void _prune(void);
+
+private:
+  mutable std::mutex _mutex;
+  ENTRIES _mEntries;
+  std::size_t _prune_size; // prune when the cache grows past this size
+};
+
+#endif // _POSITIONFACTORCACHE_HPP_
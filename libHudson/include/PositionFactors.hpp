@@ -29,6 +29,7 @@
 
 // STL
 #include <stdexcept>
+#include <vector>
 
 // Boost
 #include <boost/date_time/gregorian/gregorian.hpp>
@@ -37,6 +38,7 @@
 #include "EODDB.hpp"
 #include "Price.hpp"
 #include "PositionPtr.hpp"
+#include "PositionFactorCache.hpp"
 #include "SeriesFactor.hpp"
 #include "SeriesFactorSet.hpp"
 
@@ -65,7 +67,7 @@ class PositionFactors
 {
 public:
   /*!
-  * Initialize position daily factors for this position.
+  * Initialize position daily factors for this position. The factors are shared through PositionFactorCache.
   * \param pos Position that must be analyzed.
   */
   PositionFactors(const PositionPtr pPos, Series::EODDB::PriceType = Series::EODDB::ADJCLOSE);
@@ -84,36 +86,20 @@ private:
   const PositionPtr _pPos;
   const Series::EODDB::PriceType _pt;
 
-  // Must index SeriesFactor by date to speed up excursion calculations
-  struct SeriesFactorToTmCmp: public std::binary_function<SeriesFactor, SeriesFactor, bool>
-  {
-    bool operator()(const SeriesFactor& sf1, const SeriesFactor& sf2) const { return sf1.to_tm() < sf2.to_tm(); }
-  };
+  // Daily factors stored contiguously in to_tm order. Excursions and runs are located
+  // by row index and only the final result is copied into a SeriesFactorSet.
+  typedef PositionFactorCache::FACTORS SF_ROWS;
 
-  struct SeriesFactorFromTmCmp: public std::binary_function<SeriesFactor, SeriesFactor, bool>
-  {
-    bool operator()(const SeriesFactor& sf1, const SeriesFactor& sf2) const { return sf1.from_tm() < sf2.from_tm(); }
-  };
-
-  typedef std::set<SeriesFactor, SeriesFactorToTmCmp>   SF_TOTM;
-  typedef std::set<SeriesFactor, SeriesFactorFromTmCmp> SF_FROMTM;
-
-  SF_TOTM   _sf_totm;
-  SF_FROMTM _sf_fromtm;    
+  const PositionFactorCache::FactorsPtr _pFactors;
+  const SF_ROWS& _vFactors;
 
 private:
-  struct PeriodFactor
-  {
-    PeriodFactor(double f = 1);
-    bool isValid(void) const;
-
-    double factor;
-    boost::gregorian::date from_tm;
-    boost::gregorian::date to_tm;
-  };
-
-  PeriodFactor _wae(SF_TOTM::const_iterator& start) const;
-  PeriodFactor _bfe(SF_TOTM::const_iterator& start) const;
+  //! Rows [first, last] of the daily factors.
+  SeriesFactorSet _rows(SF_ROWS::size_type first, SF_ROWS::size_type last) const;
+  //! Rows of the worst (or best) compounded excursion. Returns false if there are no factors.
+  bool _excursion(bool worst, SF_ROWS::size_type& first, SF_ROWS::size_type& last) const;
+  //! Rows of the longest run of factors above (or below) 1. Returns false if there is none.
+  bool _run(bool positive, SF_ROWS::size_type& first, SF_ROWS::size_type& last) const;
 };
 
 
@@ -26,8 +26,10 @@
 
 // STL
 #include <string>
+#include <iterator>
 
 // Boost
+#include <boost/iterator/filter_iterator.hpp>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -54,6 +56,63 @@ typedef boost::multi_index::multi_index_container<
   >
 > __PositionSet;
 
+
+//! Select open positions.
+struct pos_is_open
+{
+  bool operator()(const PositionPtr& p) const { return p->open(); }
+};
+
+//! Select closed positions.
+struct pos_is_closed
+{
+  bool operator()(const PositionPtr& p) const { return p->closed(); }
+};
+
+//! Select positions of one type.
+struct pos_is_type
+{
+  pos_is_type(Position::Type type = Position::LONG): _type(type) { }
+  bool operator()(const PositionPtr& p) const { return p->type() == _type; }
+
+  Position::Type _type;
+};
+
+//! Select natural positions, ie not synthetic.
+struct pos_is_natural
+{
+  bool operator()(const PositionPtr& p) const { return p->type() != Position::STRATEGY; }
+};
+
+
+/*!
+  Read-only view on the positions of an iterator range that satisfy a predicate.
+  Positions are filtered while iterating, nothing is copied. A view is only valid
+  as long as the PositionSet it was taken from is not modified or destroyed.
+*/
+template <class Predicate, class Iterator>
+class PositionView
+{
+public:
+  typedef boost::filter_iterator<Predicate, Iterator> const_iterator;
+
+  PositionView(Iterator first, Iterator last, Predicate pred = Predicate()):
+    _begin(pred, first, last),
+    _end(pred, last, last)
+  {
+  }
+
+  const_iterator begin(void) const { return _begin; }
+  const_iterator end(void) const { return _end; }
+  //! Stops at the first position satisfying the predicate.
+  bool empty(void) const { return _begin == _end; }
+  std::size_t size(void) const { return std::distance(_begin, _end); }
+
+private:
+  const_iterator _begin;
+  const_iterator _end;
+};
+
 /*!
   PositionSet is a multi index PositionPtr collection indexed by Position ID,
   symbol, first Position execution (opening transaction for first Position in time)
@@ -88,7 +147,27 @@ public:
   using __PositionSet::find;
   using __PositionSet::replace;
 
+  typedef PositionView<pos_is_open, const_iterator>       open_view;
+  typedef PositionView<pos_is_closed, const_iterator>     closed_view;
+  typedef PositionView<pos_is_type, const_iterator>       type_view;
+  typedef PositionView<pos_is_natural, const_iterator>    natural_view;
+  typedef PositionView<pos_is_open, by_symbol::const_iterator>    symbol_open_view;
+  typedef PositionView<pos_is_closed, by_symbol::const_iterator>  symbol_closed_view;
+
 public:
+  //! View on all closed positions.
+  closed_view closedView(void) const { return closed_view(begin(), end()); }
+  //! View on all open positions.
+  open_view openView(void) const { return open_view(begin(), end()); }
+  //! View on all positions of type.
+  type_view typeView(Position::Type type) const { return type_view(begin(), end(), pos_is_type(type)); }
+  //! View on natural positions, ie not synthetic.
+  natural_view naturalView(void) const { return natural_view(begin(), end()); }
+  //! View on all closed positions for symbol.
+  symbol_closed_view closedView(const std::string& symbol) const;
+  //! View on all open positions for symbol.
+  symbol_open_view openView(const std::string& symbol) const;
+
   //! Return all closed positions.
   PositionSet closed(void) const;
   //! Return all open positions.
@@ -33,6 +33,7 @@
 // Hudson
 #include "PositionFactorsSet.hpp"
 #include "SeriesFactor.hpp"
+#include "ReportTable.hpp"
 
 //! Positions report.
 class PositionsReport
@@ -52,6 +53,8 @@ public:
 
   //! Print favorable and adverse statistics.
   void print(void) const;
+  //! Set average and best favorable, average and worst adverse excursions in the last row of table.
+  void fill(ReportTable& table, const std::string& prefix = "") const;
 
 private:
   const PositionFactorsSet& _pf;
@@ -29,6 +29,7 @@
 
 // STL
 #include <string>
+#include <vector>
 
 // Boost
 #include <boost/date_time/gregorian/gregorian.hpp>
@@ -66,12 +67,38 @@ public:
   */
   static Price get(const std::string& symbol, const boost::gregorian::date& dt, Series::EODDB::PriceType pt) throw(PriceException);
 
+  //! Return a price for a specific date in an already resolved series.
+  /*!
+  Looks the date up in the price columns, or in the series map if the columns are not loaded.
+  */
+  static Price get(const Series::EODSeries& series, const boost::gregorian::date& dt, Series::EODDB::PriceType pt) throw(PriceException);
+
+  //! Return the price at a column row of a series, no date lookup.
+  /*!
+  \param series The database series.
+  \param row The record row, see Series::EODSeries::row().
+  \param pt The price type.
+  \throw PriceException if the series price columns are not loaded.
+  */
+  static Price get(const Series::EODSeries& series, std::size_t row, Series::EODDB::PriceType pt) throw(PriceException);
+
   /*!
   \param symbol The name of the database series used to extract the last price.
   \param pt The price type.
   \return The last available Price of type pt in symbol series.
   */
   static Price last(const std::string& symbol, Series::EODDB::PriceType pt) throw(PriceException);
+  //! Return the last available Price of type pt in an already resolved series.
+  static Price last(const Series::EODSeries& series, Series::EODDB::PriceType pt) throw(PriceException);
+
+  /*!
+  \param series The loaded database series.
+  \param pt The price type.
+  \return The contiguous column of pt prices in series, one value per record in date order.
+  \throw PriceException if the series price columns are not loaded.
+  \see Series::EODSeries::dates()
+  */
+  static const std::vector<double>& column(const Series::EODSeries& series, Series::EODDB::PriceType pt) throw(PriceException);
   
 public:
   explicit Price(double value);
@@ -33,6 +33,7 @@
 // Hudson
 #include "ReturnFactors.hpp"
 #include "Position.hpp"
+#include "ReportTable.hpp"
 
 //! Print ReturnFactors statistics.
 class Report
@@ -82,6 +83,8 @@ public:
 
   //! Print all statistics.
   void print(void) const;
+  //! Set all statistics in the last row of table, column names starting with prefix. Percentages are fractions.
+  void fill(ReportTable& table, const std::string& prefix = "") const;
 
 private:
   const ReturnFactors& _rf;
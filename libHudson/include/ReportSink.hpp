@@ -0,0 +1,154 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _REPORTSINK_HPP_
+#define _REPORTSINK_HPP_
+
+#ifdef WIN32
+#pragma warning (disable:4290)
+#endif
+
+// STL
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+// Boost
+#include <boost/shared_ptr.hpp>
+
+// Hudson
+#include "ReportTable.hpp"
+
+
+class ReportSinkException: public std::exception
+{
+public:
+  ReportSinkException(const std::string& msg):
+    _Str("ReportSinkException: ")
+  {
+    _Str += msg;
+  }
+
+  virtual ~ReportSinkException(void) throw() { }
+  virtual const char *what(void) const throw() { return _Str.c_str(); }
+
+protected:
+  std::string _Str;
+};
+
+
+//! Machine readable output of ReportTable.
+/*!
+  A ReportSink writes whole tables to a file, or to the standard output if the path is "-".
+  Each table is formatted in memory and written with a single stream call, so one sink can be
+  shared by concurrent backtests: write() only serializes the final copy.
+  \see ReportTable.
+*/
+class ReportSink
+{
+public:
+  enum Format {
+    CSV,
+    JSONL,
+    BINARY
+  };
+
+public:
+  virtual ~ReportSink(void);
+
+  //! Write all rows of table.
+  void write(const ReportTable& table) throw(ReportSinkException);
+  //! Flush the output.
+  void flush(void);
+
+  //! New sink of format fmt writing to path.
+  static boost::shared_ptr<ReportSink> create(Format fmt, const std::string& path) throw(ReportSinkException);
+
+  //! Format name.
+  static std::string format_str(Format fmt);
+  //! Format from name: csv, jsonl or binary.
+  static Format format_from_str(const std::string& name) throw(ReportSinkException);
+
+protected:
+  ReportSink(const std::string& path, bool binary) throw(ReportSinkException);
+
+  //! Text written once before the first table. Every later table must have the same header.
+  virtual std::string _header(const ReportTable& /*table*/) const { return std::string(); }
+  //! Append the rows of table to out.
+  virtual void _format(const ReportTable& table, std::string& out) const = 0;
+
+private:
+  std::ofstream _file;
+  std::ostream* _os;
+  std::string _written_header;
+  std::mutex _mutex;
+};
+
+typedef boost::shared_ptr<ReportSink> ReportSinkPtr;
+
+
+//! Comma separated values, one header line with the column names and one line per row.
+/*!
+  Missing numbers are empty fields. Text with commas, quotes or line breaks is quoted.
+*/
+class CSVReportSink: public ReportSink
+{
+public:
+  CSVReportSink(const std::string& path) throw(ReportSinkException): ReportSink(path, false) { }
+
+protected:
+  virtual std::string _header(const ReportTable& table) const;
+  virtual void _format(const ReportTable& table, std::string& out) const;
+};
+
+
+//! One JSON object per row and line. Missing numbers are null.
+/*!
+  A table with a name adds it to each object as "table".
+*/
+class JSONLReportSink: public ReportSink
+{
+public:
+  JSONLReportSink(const std::string& path) throw(ReportSinkException): ReportSink(path, false) { }
+
+protected:
+  virtual void _format(const ReportTable& table, std::string& out) const;
+};
+
+
+//! Columnar binary tables in host byte order.
+/*!
+  Each table is one block:
+  - "HRT1" magic, uint32 name length, name
+  - uint32 columns, uint64 rows
+  - each column: uint8 type (0 number, 1 text), uint32 name length, name, then all its values:
+    rows doubles for NUMBER, rows times uint32 length and bytes for TEXT.
+  Number columns can be read straight into a double array.
+*/
+class BinaryReportSink: public ReportSink
+{
+public:
+  BinaryReportSink(const std::string& path) throw(ReportSinkException): ReportSink(path, true) { }
+
+protected:
+  virtual void _format(const ReportTable& table, std::string& out) const;
+};
+
+#endif // _REPORTSINK_HPP_
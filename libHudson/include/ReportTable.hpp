@@ -0,0 +1,121 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _REPORTTABLE_HPP_
+#define _REPORTTABLE_HPP_
+
+#ifdef WIN32
+#pragma warning (disable:4290)
+#endif
+
+// STL
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+class ReportTableException: public std::exception
+{
+public:
+  ReportTableException(const std::string& msg):
+    _Str("ReportTableException: ")
+  {
+    _Str += msg;
+  }
+
+  virtual ~ReportTableException(void) throw() { }
+  virtual const char *what(void) const throw() { return _Str.c_str(); }
+
+protected:
+  std::string _Str;
+};
+
+
+//! Named, typed columns of report values.
+/*!
+  Reports fill one row of a ReportTable instead of printing, a backtest sweep collects one row per run.
+  The whole table is then written at once by a ReportSink.
+
+  Values are stored by column. Columns can be added at any time, rows already in the table get a missing
+  value: NaN for NUMBER columns and an empty string for TEXT columns.
+  \see ReportSink.
+*/
+class ReportTable
+{
+public:
+  enum ColumnType {
+    NUMBER,
+    TEXT
+  };
+
+public:
+  ReportTable(const std::string& name = "");
+
+  //! Table name.
+  const std::string& name(void) const { return _name; }
+
+  //! Index of column name, added with type if it does not exist.
+  std::size_t column(const std::string& name, ColumnType type = NUMBER) throw(ReportTableException);
+  //! Index of column name, columns() if it does not exist.
+  std::size_t find(const std::string& name) const;
+
+  //! Append a row of missing values. Returns the new row index.
+  std::size_t add_row(void);
+
+  //! Set column name of the last row, adding the column if needed.
+  void set(const std::string& name, double value) throw(ReportTableException);
+  void set(const std::string& name, const std::string& value) throw(ReportTableException);
+  //! Set column col of row.
+  void set(std::size_t col, std::size_t row, double value) throw(ReportTableException);
+  void set(std::size_t col, std::size_t row, const std::string& value) throw(ReportTableException);
+
+  //! Append the rows of table, matching columns by name.
+  void append(const ReportTable& table) throw(ReportTableException);
+  //! Remove all rows, keeping the columns.
+  void clear(void);
+
+  std::size_t rows(void) const { return _rows; }
+  std::size_t columns(void) const { return _vColumns.size(); }
+
+  const std::string& column_name(std::size_t col) const { return _vColumns[col].name; }
+  ColumnType column_type(std::size_t col) const { return _vColumns[col].type; }
+
+  //! All values of a NUMBER column.
+  const std::vector<double>& numbers(std::size_t col) const { return _vColumns[col].numbers; }
+  //! All values of a TEXT column.
+  const std::vector<std::string>& texts(std::size_t col) const { return _vColumns[col].texts; }
+
+private:
+  struct Column
+  {
+    std::string name;
+    ColumnType type;
+    std::vector<double> numbers;
+    std::vector<std::string> texts;
+  };
+
+  Column& _at(std::size_t col, std::size_t row, ColumnType type) throw(ReportTableException);
+
+private:
+  std::string _name;
+  std::vector<Column> _vColumns;
+  std::size_t _rows;
+};
+
+#endif // _REPORTTABLE_HPP_
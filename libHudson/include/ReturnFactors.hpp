@@ -37,6 +37,7 @@
 #include <boost/date_time/gregorian/gregorian.hpp>
 
 // Hudson
+#include "OnlineReturnFactors.hpp"
 #include "PositionSet.hpp"
 
 
@@ -72,6 +73,8 @@ public:
 
   //! Return the total number of positions passed in the constructor.
   int num(void) const;
+  //! Return the positions passed in the constructor.
+  const PositionSet& positions(void) const { return _sPositions; }
 
   //! Return the return on investment.
   double roi(void) const;
@@ -157,13 +160,16 @@ protected:
     bool operator()(const PositionSet& pset1, const PositionSet& pset2) const { return pset1.realized() < pset2.realized(); }
   };
 
-  PositionSet _dd(PositionSet::by_last_exec::iterator& start) const;
+  typedef std::vector<double> doubleVector;
+
+  //! Rows [first, last] of _vFactors with the lowest compounded factor. Returns false if no sequence is below 1.
+  bool _dd(doubleVector::size_type& first, doubleVector::size_type& last) const;
 
 protected:
   PositionSet _sPositions;
 
-  typedef std::vector<double> doubleVector;
   doubleVector _vFactors; // time-ordered position factors for fast array calculations
+  OnlineReturnFactors _stats; // running statistics of _vFactors
 
   double _fvalue;			// future value
   double _mean;				// factors average
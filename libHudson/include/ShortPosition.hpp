@@ -98,12 +98,12 @@ public:
   //! Add a ShortExecution.
   virtual void sell_short(const boost::gregorian::date& dt, const Price& price, unsigned size) throw(PositionException);
   //! Add a ShortExecution.
-  virtual void sell_short(const boost::gregorian::date& dt, Series::EODDB::PriceType pt, unsigned size) throw(PositionException) { sell_short(dt, Price::get(_symbol, dt, pt), size); }
+  virtual void sell_short(const boost::gregorian::date& dt, Series::EODDB::PriceType pt, unsigned size) throw(PositionException) { sell_short(dt, Price::get(series(), dt, pt), size); }
  
   //! Add a CoverExecution.
   virtual void cover(const boost::gregorian::date& dt, const Price& price, unsigned size) throw(PositionException);
   //! Add a CoverExecution.
-  virtual void cover(const boost::gregorian::date& dt, Series::EODDB::PriceType pt, unsigned size) throw(PositionException) { cover(dt, Price::get(_symbol, dt, pt), size); }
+  virtual void cover(const boost::gregorian::date& dt, Series::EODDB::PriceType pt, unsigned size) throw(PositionException) { cover(dt, Price::get(series(), dt, pt), size); }
   
   //! Close any open short size by adding a cover Execution.
   virtual void close(const boost::gregorian::date& dt, const Price& price) throw(PositionException);
@@ -112,7 +112,7 @@ public:
     \param dt The series date that will be used to retrieve a matching market price.
     \param pt The type of price that will be used to close the Position.
   */
-  virtual void close(const boost::gregorian::date& dt, Series::EODDB::PriceType pt) throw(PositionException) { close(dt, Price::get(_symbol, dt, pt)); }
+  virtual void close(const boost::gregorian::date& dt, Series::EODDB::PriceType pt) throw(PositionException) { close(dt, Price::get(series(), dt, pt)); }
   
 private:
   unsigned _shorts;
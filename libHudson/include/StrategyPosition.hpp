@@ -26,8 +26,8 @@
 
 // STL
 #include <string>
-#include <set>
 #include <map>
+#include <vector>
 
 // Hudson
 #include "Price.hpp"
@@ -113,6 +113,7 @@ public:
   //! Return series factors until dt using PriceType pt.
   virtual SeriesFactorSet factors(const boost::gregorian::date& dt, Series::EODDB::PriceType pt = Series::EODDB::ADJCLOSE) const throw(PositionException);
   //! Return all factors for the period dp using PriceType pt.
+  //! Leg factors with the same from/to dates are combined as 1 + sum(factor - 1), in time linear in the number of leg factors.
   virtual SeriesFactorSet factors(const boost::gregorian::date_period& dp, Series::EODDB::PriceType pt = Series::EODDB::ADJCLOSE) const throw(PositionException);
 
   //! Always throw an exception. A StrategyPosition can not be bought directly. See get() to buy a specific LongPosition.
@@ -148,26 +149,32 @@ public:
   //! Execution notification for underlying NaturalPosition instances
   virtual void update(const ExecutionPtr pExe);
 
-protected:
   struct PositionWeight
   {
     PositionPtr pPos;
     double weight;
   };
   typedef std::map<Position::ID, PositionWeight> POSW_MAP;
+
+  //! Underlying Position objects and their weights by Position ID.
+  const POSW_MAP& legs(void) const { return _mPositions; }
+
+protected:
   //! Position/weight mapping
   POSW_MAP _mPositions;
 
 private:
-  struct SeriesFactorFromCmp: public std::binary_function<SeriesFactor, SeriesFactor, bool>
+  //! Order SeriesFactor by from date, then to date
+  struct SeriesFactorPeriodCmp: public std::binary_function<SeriesFactor, SeriesFactor, bool>
   {
-    bool operator()(const SeriesFactor& sf1, const SeriesFactor& sf2) const { return sf1.from_tm() < sf2.from_tm(); }
+    bool operator()(const SeriesFactor& sf1, const SeriesFactor& sf2) const
+    {
+      return sf1.from_tm() < sf2.from_tm() || (sf1.from_tm() == sf2.from_tm() && sf1.to_tm() < sf2.to_tm());
+    }
   };
 
-  //! Set of SeriesFactor indexed by 'from' date
-  typedef std::multiset<SeriesFactor, SeriesFactorFromCmp> SeriesFactorMultiSetFrom;
-
-  SeriesFactorSet _matchFactors(const SeriesFactorMultiSetFrom& sfsAll) const;
+  //! Daily factors stored contiguously, ordered by SeriesFactorPeriodCmp
+  typedef std::vector<SeriesFactor> SF_ROWS;
 };
 
 #endif // _STRATEGYPOSITION_HPP_
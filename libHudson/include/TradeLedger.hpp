@@ -0,0 +1,136 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _TRADELEDGER_HPP_
+#define _TRADELEDGER_HPP_
+
+#ifdef WIN32
+#pragma warning (disable:4290)
+#endif
+
+// STL
+#include <map>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/cstdint.hpp>
+#include <boost/date_time/gregorian/gregorian.hpp>
+
+// Hudson
+#include "Execution.hpp"
+#include "Position.hpp"
+#include "PositionSet.hpp"
+#include "Price.hpp"
+
+
+class TradeLedgerException: public std::exception
+{
+public:
+  TradeLedgerException(const std::string& msg):
+    _Str("TradeLedgerException: ")
+  {
+    _Str += msg;
+  }
+
+  virtual ~TradeLedgerException(void) throw() { }
+  virtual const char *what(void) const throw() { return _Str.c_str(); }
+
+protected:
+  std::string _Str;
+};
+
+
+/*!
+  TradeLedger records long and short positions as flat, append-only arrays of executions and positions.
+  Symbols are interned and every symbol keeps a bitmap of its open positions, so checking for or closing
+  open positions doesn't build any collection. Position objects are only created by positions(), which
+  replays the executions recorded since its last call, for use with the reporting classes.
+  \see Trader::setLedger()
+*/
+class TradeLedger
+{
+public:
+  TradeLedger(void);
+
+  //! Open a new LONG or SHORT position.
+  void open(Position::ID id, Position::Type type, const std::string& symbol, const boost::gregorian::date& dt, const Price& price, unsigned size) throw(TradeLedgerException);
+  //! Add an execution to an existing position.
+  void execute(Position::ID id, Execution::Side side, const boost::gregorian::date& dt, const Price& price, unsigned size) throw(TradeLedgerException);
+  //! Close the open size of an existing position.
+  void close(Position::ID id, const boost::gregorian::date& dt, const Price& price) throw(TradeLedgerException);
+
+  //! Number of positions.
+  std::size_t size(void) const { return _vPositions.size(); }
+  bool empty(void) const { return _vPositions.empty(); }
+  //! Is there a position with this id.
+  bool has(Position::ID id) const;
+  //! Has the position with this id been closed.
+  bool closed(Position::ID id) const throw(TradeLedgerException);
+  //! Return factor of a closed position, from its average entry and exit prices.
+  double factor(Position::ID id) const throw(TradeLedgerException);
+  //! Is any position open for symbol.
+  bool hasOpen(const std::string& symbol) const;
+  //! Ids of the open positions for symbol, in id order.
+  std::vector<Position::ID> openIds(const std::string& symbol) const;
+
+  //! Return all open and closed positions as Position objects.
+  PositionSet positions(void) const throw(TradeLedgerException);
+
+private:
+  struct LedgerExecution {
+    std::size_t pos;      // index in _vPositions
+    Execution::Side side;
+    boost::gregorian::date dt;
+    Price price;
+    unsigned size;
+  };
+
+  struct LedgerPosition {
+    Position::ID id;
+    unsigned symbol;      // index in _vSymbols
+    Position::Type type;
+    unsigned size;        // current open size
+    double entryValue;    // sum of entry price * size
+    unsigned entrySize;
+    double exitValue;     // sum of exit price * size
+    unsigned exitSize;
+  };
+
+  typedef std::vector<boost::uint64_t> Bitmap;
+
+  std::size_t _find(Position::ID id) const throw(TradeLedgerException);
+  unsigned _intern(const std::string& symbol);
+  void _setOpen(const LedgerPosition& pos, std::size_t index, bool open);
+
+private:
+  std::vector<LedgerExecution> _vExecutions;
+  std::vector<LedgerPosition> _vPositions;    // in id order
+  std::vector<std::string> _vSymbols;
+  std::map<std::string, unsigned> _mSymbols;
+  std::vector<Bitmap> _vOpen;                 // per symbol, one bit per position
+  std::vector<std::size_t> _vOpenCount;       // per symbol
+
+  // Position objects built by positions()
+  mutable std::vector<PositionPtr> _vBuilt;
+  mutable std::size_t _replayed;
+  mutable PositionSet _sBuilt;
+};
+
+#endif // _TRADELEDGER_HPP_
@@ -25,14 +25,19 @@
 #endif
 
 // STL
+#include <atomic>
+#include <map>
 #include <string>
+#include <vector>
 
 // Boost
 #include <boost/date_time/gregorian/gregorian.hpp>
 
 // Hudson
+#include "OnlineReturnFactors.hpp"
 #include "PositionSet.hpp"
 #include "Price.hpp"
+#include "TradeLedger.hpp"
 
 
 class TraderException: public std::exception
@@ -63,6 +68,14 @@ public:
   Trader(void);
   virtual ~Trader(void) { }
 
+  /*!
+  \brief Record long and short positions in a TradeLedger instead of Position objects.
+  Position objects are then only built when positions() is called. Must be set before the first trade.
+  \note StrategyTrader positions can't be recorded in the ledger.
+  \see TradeLedger
+  */
+  void setLedger(bool ledger = true) throw(TraderException);
+
   /*!
   \brief Buy to open a new LongPosition at a specific price.
   \param symbol The name of the LongPosition.
@@ -130,23 +143,58 @@ public:
   /*!
   \brief Return all open and closed positions.
   */
-  PositionSet positions(void) const { return _miPositions; }
+  PositionSet positions(void) const throw(TraderException);
   /*!
   \brief Return all opened and closed positions for a specific symbol.
   \param symbol The name of the Position objects that will be returned.
   */
   PositionSet positions(const std::string& symbol);
 
+  /*!
+  \brief Is any position open for symbol.
+  Answered from an index of open positions per symbol, the PositionSet is not scanned.
+  */
+  bool hasOpen(const std::string& symbol) const;
+  /*!
+  \brief Return the ids of all open positions for symbol.
+  */
+  std::vector<Position::ID> openIds(const std::string& symbol) const;
+
+  /*!
+  \brief Return statistics of the positions closed so far, in closing order.
+  Updated on every closing execution, so they are available during the backtest without building a ReturnFactors.
+  StrategyPosition factors are included when closed by StrategyTrader::strategy_close().
+  */
+  const OnlineReturnFactors& stats(void) const { return _stats; }
+
 protected:
   /*!
   \brief Find Position by position id. Throw an exception if not found.
   Application should use the public helper functions and in general not rely on single position extraction.
   */
   PositionPtr get(Position::ID id) const throw(TraderException);
+  /*!
+  \brief Add a newly created position to the open positions index.
+  */
+  void _indexOpen(const PositionPtr& pPos);
+  /*!
+  \brief Add the factor of pPos to stats() if it is closed.
+  */
+  void _closed(const PositionPtr& pPos);
+
+private:
+  void _ledgerExecute(Position::ID id, Execution::Side side, const boost::gregorian::date& dt, const Price& price, unsigned size) throw(TraderException);
+  void _pruneOpen(std::vector<PositionPtr>& vOpen) const;
+
+  typedef std::map<std::string, std::vector<PositionPtr> > OpenIndex;
  
 protected:
-  static Position::ID _pid; //! Unique Position id
+  static std::atomic<Position::ID> _pid; //! Unique Position id, shared by traders running in parallel
   PositionSet _miPositions; //! Complete set of open/closed PositionPtr for this Trader
+  bool _ledgerMode; //! Trades are recorded in _ledger
+  TradeLedger _ledger; //! Flat record of long and short trades in ledger mode
+  mutable OpenIndex _mOpen; //! Positions per symbol still open when last looked up, in id order
+  OnlineReturnFactors _stats; //! Running statistics of closed positions
 };
 
 #endif // _TRADER_HPP_
@@ -0,0 +1,325 @@
+/*
+* Copyright (C) 2007,2008, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StdAfx.hpp"
+
+// CSTD
+#include <cmath>
+
+// STL
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <set>
+
+// Hudson
+#include "DailyEquity.hpp"
+#include "StrategyPosition.hpp"
+
+using namespace std;
+using namespace boost::gregorian;
+using namespace Series;
+
+
+DailyEquity::DailyEquity( const PositionSet& sPositions, const date& begin, const date& end, double rf_rate, EODDB::PriceType pt ) throw(DailyEquityException):
+  _begin(begin),
+  _end(end),
+  _rf_rate(rf_rate),
+  _pt(pt),
+  _mean(0),
+  _stddev(0),
+  _downside(0),
+  _dd(0),
+  _dd_period(begin, begin)
+{
+  _vSleeves.push_back(Sleeve(&sPositions, 1));
+  _calculate();
+}
+
+
+DailyEquity::DailyEquity( const PortfolioReturns& pr, const date& begin, const date& end, double rf_rate, EODDB::PriceType pt ) throw(DailyEquityException):
+  _begin(begin),
+  _end(end),
+  _rf_rate(rf_rate),
+  _pt(pt),
+  _mean(0),
+  _stddev(0),
+  _downside(0),
+  _dd(0),
+  _dd_period(begin, begin)
+{
+  for( unsigned i = 0; i < pr.series(); ++i )
+    _vSleeves.push_back(Sleeve(&pr.returns(i).positions(), pr.weight(i)));
+
+  _calculate();
+}
+
+
+double DailyEquity::roi( void ) const
+{
+  return _vNAV.empty() ? 0 : _vNAV.back() - 1;
+}
+
+
+double DailyEquity::volatility( void ) const
+{
+  return _stddev * ::sqrt((double)TRADING_DAYS);
+}
+
+
+double DailyEquity::sharpe( void ) const
+{
+  if( _stddev == 0 )
+    return 0;
+
+  return ((_mean * TRADING_DAYS) - (_rf_rate/100.0)) / (_stddev * ::sqrt((double)TRADING_DAYS));
+}
+
+
+double DailyEquity::sortino( void ) const
+{
+  if( _downside == 0 )
+    return 0;
+
+  return ((_mean * TRADING_DAYS) - (_rf_rate/100.0)) / (_downside * ::sqrt((double)TRADING_DAYS));
+}
+
+
+void DailyEquity::_calculate( void ) throw(DailyEquityException)
+{
+  if( _end < _begin )
+    throw DailyEquityException("Invalid equity curve period");
+
+  _calendar();
+
+  const size_t days = _vDates.size();
+  const double cash = 1 + (_rf_rate/100/TRADING_DAYS);
+
+  // Each sleeve is marked in one pass over the rows held by its positions, then blended by weight
+  double accWeight = 0;
+  _vFactors.assign(days, 0);
+  for( size_t s = 0; s < _vSleeves.size(); ++s ) {
+
+    doubleVector sleeve(days, 1);
+    vector<bool> held(days, false);
+
+    const PositionSet& sPositions = *_vSleeves[s].pPositions;
+    for( PositionSet::const_iterator iter = sPositions.begin(); iter != sPositions.end(); ++iter )
+      _mark(*iter, sleeve, held);
+
+    const double w = _vSleeves[s].w;
+    for( size_t k = 1; k < days; ++k )
+      _vFactors[k] += w * (held[k] ? sleeve[k] : cash);
+
+    accWeight += w;
+  }
+
+  // Any weight not allocated to a sleeve stays flat
+  for( size_t k = 1; k < days; ++k )
+    _vFactors[k] += (1 - accWeight);
+
+  if( days )
+    _vFactors[0] = 1;
+
+  // NAV and drawdown from the running peak
+  _vNAV.assign(days, 1);
+  double peak = 1;
+  size_t peak_row = 0;
+  for( size_t k = 1; k < days; ++k ) {
+    _vNAV[k] = _vNAV[k-1] * _vFactors[k];
+
+    if( _vNAV[k] > peak ) {
+      peak = _vNAV[k];
+      peak_row = k;
+    }
+
+    if( _vNAV[k] / peak - 1 < _dd ) {
+      _dd = _vNAV[k] / peak - 1;
+      _dd_period = date_period(_vDates[peak_row], _vDates[k]);
+    }
+  }
+
+  // Daily return statistics
+  if( days < 3 )
+    return;
+
+  const size_t n = days - 1;
+  _mean = (accumulate(_vFactors.begin() + 1, _vFactors.end(), 0.0) - n) / n;
+
+  const double rf_daily = cash - 1;
+  double var_acc = 0, down_acc = 0;
+  for( size_t k = 1; k < days; ++k ) {
+    const double r = _vFactors[k] - 1;
+    var_acc += ::pow(r - _mean, 2);
+    if( r < rf_daily )
+      down_acc += ::pow(r - rf_daily, 2);
+  }
+
+  _stddev = ::sqrt(var_acc / (n - 1));
+  _downside = ::sqrt(down_acc / n);
+}
+
+
+void DailyEquity::_calendar( void ) throw(DailyEquityException)
+{
+  vector<date> vAll;
+  set<string> sSymbols;
+
+  for( size_t s = 0; s < _vSleeves.size(); ++s ) {
+    const PositionSet& sPositions = *_vSleeves[s].pPositions;
+
+    // Natural positions and strategy legs, one series per symbol
+    vector<PositionPtr> vNatural;
+    for( PositionSet::const_iterator iter = sPositions.begin(); iter != sPositions.end(); ++iter ) {
+      if( (*iter)->type() != Position::STRATEGY ) {
+        vNatural.push_back(*iter);
+        continue;
+      }
+
+      const StrategyPosition& strategy = dynamic_cast<const StrategyPosition&>(**iter);
+      for( StrategyPosition::POSW_MAP::const_iterator citer = strategy.legs().begin(); citer != strategy.legs().end(); ++citer )
+        vNatural.push_back((*citer).second.pPos);
+    }
+
+    for( size_t i = 0; i < vNatural.size(); ++i ) {
+      if( !sSymbols.insert(vNatural[i]->symbol()).second )
+        continue;
+
+      const vector<date>& dates = vNatural[i]->series().dates();
+      vAll.insert(vAll.end(), lower_bound(dates.begin(), dates.end(), _begin), upper_bound(dates.begin(), dates.end(), _end));
+    }
+  }
+
+  sort(vAll.begin(), vAll.end());
+  vAll.erase(unique(vAll.begin(), vAll.end()), vAll.end());
+  _vDates.swap(vAll);
+}
+
+
+const DailyEquity::doubleVector& DailyEquity::_prices( const PositionPtr pPos ) throw(DailyEquityException)
+{
+  SYMBOL_PRICES::iterator iter = _mPrices.find(pPos->symbol());
+  if( iter != _mPrices.end() )
+    return iter->second;
+
+  const EODSeries& series = pPos->series();
+  const vector<date>& dates = series.dates();
+  const vector<double>* column = 0;
+  try {
+    column = &Price::column(series, _pt);
+  } catch( const exception& ex ) {
+    throw DailyEquityException(ex.what());
+  }
+
+  // Forward fill the series on the calendar, walking both date arrays once
+  doubleVector& prices = _mPrices[pPos->symbol()];
+  prices.assign(_vDates.size(), numeric_limits<double>::quiet_NaN());
+
+  size_t row = _vDates.empty() ? EODSeries::npos : series.row_at_or_before(_vDates.front());
+  size_t next = (row == EODSeries::npos) ? 0 : row + 1;
+  for( size_t k = 0; k < _vDates.size(); ++k ) {
+    while( next < dates.size() && dates[next] <= _vDates[k] )
+      row = next++;
+
+    if( row != EODSeries::npos )
+      prices[k] = (*column)[row];
+  }
+
+  return prices;
+}
+
+
+bool DailyEquity::_span( const PositionPtr pPos, size_t& first, size_t& last ) const throw(DailyEquityException)
+{
+  if( _vDates.empty() )
+    return false;
+
+  const date first_dt = pPos->first_exec()->dt();
+  const date last_dt = pPos->closed() ? pPos->last_exec()->dt() : _end;
+
+  first = lower_bound(_vDates.begin(), _vDates.end(), first_dt) - _vDates.begin();
+  last = upper_bound(_vDates.begin(), _vDates.end(), last_dt) - _vDates.begin();
+  if( last == 0 )
+    return false;
+  --last;
+
+  return first < last;
+}
+
+
+void DailyEquity::_mark( const PositionPtr pPos, doubleVector& acc, vector<bool>& held ) throw(DailyEquityException)
+{
+  size_t first = 0, last = 0;
+
+  if( pPos->type() != Position::STRATEGY ) {
+    if( !_span(pPos, first, last) )
+      return;
+
+    const doubleVector& prices = _prices(pPos);
+    const bool inverse = (pPos->type() == Position::SHORT);
+    for( size_t k = first + 1; k <= last; ++k ) {
+      if( std::isnan(prices[k-1]) || std::isnan(prices[k]) )
+        continue;
+
+      acc[k] *= (inverse ? prices[k-1] / prices[k] : prices[k] / prices[k-1]);
+      held[k] = true;
+    }
+    return;
+  }
+
+  // Strategy: combine the weighted leg returns of each day
+  const StrategyPosition& strategy = dynamic_cast<const StrategyPosition&>(*pPos);
+  doubleVector delta(acc.size(), 0);
+  vector<bool> strategy_held(acc.size(), false);
+
+  for( StrategyPosition::POSW_MAP::const_iterator citer = strategy.legs().begin(); citer != strategy.legs().end(); ++citer ) {
+    const PositionPtr pLeg = (*citer).second.pPos;
+    if( pLeg->type() == Position::STRATEGY )
+      throw DailyEquityException("Nested StrategyPosition not supported");
+
+    if( !_span(pLeg, first, last) )
+      continue;
+
+    const doubleVector& prices = _prices(pLeg);
+    const bool inverse = (pLeg->type() == Position::SHORT);
+    const double w = (*citer).second.weight;
+    for( size_t k = first + 1; k <= last; ++k ) {
+      if( std::isnan(prices[k-1]) || std::isnan(prices[k]) )
+        continue;
+
+      delta[k] += w * ((inverse ? prices[k-1] / prices[k] : prices[k] / prices[k-1]) - 1);
+      strategy_held[k] = true;
+    }
+  }
+
+  for( size_t k = 1; k < acc.size(); ++k ) {
+    if( !strategy_held[k] )
+      continue;
+
+    acc[k] *= (1 + delta[k]);
+    held[k] = true;
+  }
+}
+
+
+DailyEquity::Sleeve::Sleeve( const PositionSet* pPositions_, double w_ ):
+  pPositions(pPositions_),
+  w(w_)
+{
+}
@@ -72,15 +72,31 @@ void Series::EODDB::load(const std::string& name, const std::string& filename, D
   EODSeries* pSeries = new EODSeries(name);
   pSeries->load(*pFD, filename, begin, end);
 
-  _sDB.insert(DB::value_type(name, pSeries));
+  _sDB.insert(DB::value_type(name, _vSeries.size()));
+  _vSeries.push_back(pSeries);
 }
 
 
 const Series::EODSeries& Series::EODDB::get(const std::string& name) const throw(EODDBException)
+{
+  return *_vSeries[id(name)];
+}
+
+
+Series::EODDB::SeriesID Series::EODDB::id(const std::string& name) const throw(EODDBException)
 {
   DB::const_iterator iter;
   if( (iter = _sDB.find(name)) == _sDB.end() )
     throw EODDBException("Unknown series");
 
-  return *(iter->second);
+  return iter->second;
+}
+
+
+const Series::EODSeries& Series::EODDB::get(SeriesID id) const throw(EODDBException)
+{
+  if( id >= _vSeries.size() )
+    throw EODDBException("Unknown series id");
+
+  return *_vSeries[id];
 }
@@ -21,6 +21,9 @@
 
 #include "StdAfx.hpp"
 
+// STL
+#include <algorithm>
+
 // Hudson
 #include "EODSeries.hpp"
 #include "EOWSeries.hpp"
@@ -29,6 +32,8 @@
 using namespace std;
 using namespace boost::gregorian;
 
+const std::size_t Series::EODSeries::npos = static_cast<std::size_t>(-1);
+
 
 Series::EODSeries::EODSeries(const std::string& name):
   _name(name),
@@ -64,6 +69,7 @@ size_t Series::EODSeries::load(FileDriver& driver, const std::string& filename)
 
   driver.close();
 
+  _buildColumns();
   _isLoaded = true;
 
   return std::map<boost::gregorian::date, DayPrice>::size();
@@ -100,12 +106,54 @@ size_t Series::EODSeries::load(FileDriver& driver, const std::string& filename,
 
   driver.close();
 
+  _buildColumns();
   _isLoaded = true;
 
   return ThisMap::size();
 }
 
 
+void Series::EODSeries::_buildColumns(void)
+{
+  _vDates.clear();
+  _vOpen.clear();
+  _vClose.clear();
+  _vAdjClose.clear();
+
+  _vDates.reserve(ThisMap::size());
+  _vOpen.reserve(ThisMap::size());
+  _vClose.reserve(ThisMap::size());
+  _vAdjClose.reserve(ThisMap::size());
+
+  for( ThisMap::const_iterator iter = ThisMap::begin(); iter != ThisMap::end(); ++iter ) {
+    _vDates.push_back(iter->first);
+    _vOpen.push_back(iter->second.open);
+    _vClose.push_back(iter->second.close);
+    _vAdjClose.push_back(iter->second.adjclose);
+  }
+}
+
+
+std::size_t Series::EODSeries::row(const boost::gregorian::date& dt) const
+{
+  vector<date>::const_iterator iter = std::lower_bound(_vDates.begin(), _vDates.end(), dt);
+  if( iter == _vDates.end() || *iter != dt )
+    return npos;
+
+  return iter - _vDates.begin();
+}
+
+
+std::size_t Series::EODSeries::row_at_or_before(const boost::gregorian::date& dt) const
+{
+  vector<date>::const_iterator iter = std::upper_bound(_vDates.begin(), _vDates.end(), dt);
+  if( iter == _vDates.begin() )
+    return npos;
+
+  return (iter - _vDates.begin()) - 1;
+}
+
+
 boost::gregorian::date_period Series::EODSeries::period(void) const throw(EODSeriesException)
 {
   if( empty() )
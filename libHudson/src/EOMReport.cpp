@@ -49,3 +49,13 @@ void EOMReport::print( void ) const
   cout.precision(curr_precision);
   cout.flags(curr_flags);
 }
+
+
+void EOMReport::fill( ReportTable& table, const std::string& prefix ) const
+{
+  Report::fill(table, prefix);
+
+  table.set(prefix + "cagr", _eomrf.cagr());
+  table.set(prefix + "gsdm", _eomrf.gsd());
+  table.set(prefix + "sharpe", _eomrf.sharpe());
+}
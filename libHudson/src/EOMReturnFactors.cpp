@@ -79,6 +79,17 @@ double EOMReturnFactors::sharpe( void ) const
 
 void EOMReturnFactors::_calculateM2M(void)
 {
+  // Sweep months over positions sorted by opening date. A position becomes active once opened by the
+  // end-of-month mark and is retired once its holding period ended before the current month, so each
+  // month only visits the positions that can intersect it.
+  vector<PositionPtr> vByOpen(_sPositions.begin(), _sPositions.end());
+  stable_sort(vByOpen.begin(), vByOpen.end(), PositionOpenCmp());
+  vector<PositionPtr>::const_iterator next = vByOpen.begin();
+
+  // Active positions by id, keeping the PositionSet multiplication order, with their holding period
+  typedef map<Position::ID, pair<PositionPtr, date_period> > ACTIVE;
+  ACTIVE mActive;
+
   // For each month in selected period
   date prev_em_mark(_begin);
   date em_mark;
@@ -88,15 +99,27 @@ void EOMReturnFactors::_calculateM2M(void)
     date_period month_period(prev_em_mark, em_mark);
     //cout << "Calculating M2M factor for period " << month_period << endl;
 
-    // For each position
+    for( ; next != vByOpen.end() && (*next)->first_exec()->dt() <= em_mark; ++next )
+      mActive.insert(ACTIVE::value_type((*next)->id(), make_pair(*next, (*next)->hold_period())));
+
+    // For each active position
     double f_acc = 1;
     bool cash = true;
-    for( PositionSet::const_iterator piter(_sPositions.begin()); piter != _sPositions.end(); ++piter ) {
+    for( ACTIVE::iterator aiter = mActive.begin(); aiter != mActive.end(); ) {
+
+      PositionPtr pPos = aiter->second.first;
+      const date_period& hold_period = aiter->second.second;
+
+      // Retire positions closed before prev_em_mark, they can't intersect this or any later month
+      if( hold_period.end() < prev_em_mark ) {
+        mActive.erase(aiter++);
+        continue;
+      }
+      ++aiter;
 
-      PositionPtr pPos = *piter;
-      // Skip positions closed before prev_em_mark or opened after em_mark
-      if( ! month_period.intersects(pPos->hold_period()) ) {
-        //cout << "Skipping position " << pPos->id() << ", holding period " << pPos->hold_period() << ", current monthly period " << month_period << endl;
+      // Skip positions not holding during this month
+      if( ! month_period.intersects(hold_period) ) {
+        //cout << "Skipping position " << pPos->id() << ", holding period " << hold_period << ", current monthly period " << month_period << endl;
         continue;
       }
 
@@ -27,7 +27,7 @@
 
 using namespace std;
 
-Execution::ID ExecutionSet::_eid = 0;
+std::atomic<Execution::ID> ExecutionSet::_eid(0);
 
 
 ExecutionSet::ExecutionSet(void)
@@ -46,47 +46,51 @@ void ExecutionSet::print(void) const
 
 Execution::ID ExecutionSet::buy(const std::string& symbol, const boost::gregorian::date& dt, const Price& price, unsigned size)
 {
-  ExecutionPtr pExe(new BuyExecution(symbol, ++_eid, dt, price, size));
+  const Execution::ID id = ++_eid;
+  ExecutionPtr pExe(new BuyExecution(symbol, id, dt, price, size));
   if( insert(pExe).second == false )
     return Execution::NullID;
 
   notify(pExe); // Notify all observers about new execution
 
-  return _eid;
+  return id;
 }
 
 
 Execution::ID ExecutionSet::sell(const std::string& symbol, const boost::gregorian::date& dt, const Price& price, unsigned size)
 {
-  ExecutionPtr pExe(new SellExecution(symbol, ++_eid, dt, price, size));
+  const Execution::ID id = ++_eid;
+  ExecutionPtr pExe(new SellExecution(symbol, id, dt, price, size));
   if( insert(pExe).second == false )
     return Execution::NullID;
 
   notify(pExe);
 
-  return _eid;
+  return id;
 }
 
 
 Execution::ID ExecutionSet::sell_short(const std::string& symbol, const boost::gregorian::date& dt, const Price& price, unsigned size)
 {
-  ExecutionPtr pExe(new SellShortExecution(symbol, ++_eid, dt, price, size));
+  const Execution::ID id = ++_eid;
+  ExecutionPtr pExe(new SellShortExecution(symbol, id, dt, price, size));
   if( insert(pExe).second == false )
     return Execution::NullID;
 
   notify(pExe);
 
-  return _eid;
+  return id;
 }
 
 
 Execution::ID ExecutionSet::cover(const std::string& symbol, const boost::gregorian::date& dt, const Price& price, unsigned size)
 {
-  ExecutionPtr pExe(new CoverExecution(symbol, ++_eid, dt, price, size));
+  const Execution::ID id = ++_eid;
+  ExecutionPtr pExe(new CoverExecution(symbol, id, dt, price, size));
   if( insert(pExe).second == false )
     return Execution::NullID;
 
   notify(pExe);
 
-  return _eid;
+  return id;
 }
@@ -113,31 +113,54 @@ bool IndicatorApp::next() {
 
 //**************************************************************************************************************************
 double IndicatorApp::evaluate( const std::string& indicator, const std::string& ext ) {
- 
+
+  return lookup( m_iter->first, indicator, ext );
+}
+
+
+//**************************************************************************************************************************
+double IndicatorApp::value( const std::string& indicator, const boost::gregorian::date& date, const std::string& ext ) const {
+
+  if( date < getStartDate() ) {
+    std::cerr << "FATAL: IndicatorApp - trying to acces date that doesn't exist.\n";
+    exit(EXIT_FAILURE);
+  }
+  return lookup( m_db.at_or_before( date )->first, indicator, ext );
+}
+
+
+//**************************************************************************************************************************
+std::vector< double > IndicatorApp::column( const std::string& indicator, const std::string& ext ) const {
+
+  std::vector< double > values;
+  if( m_max_period >= static_cast< int >( m_db.size() ) ) return values;
+  values.reserve( m_db.size() - m_max_period );
+
+  Series::EODSeries::const_iterator iter( m_db.begin() );
+  std::advance( iter, m_max_period );
+  for( ; iter != m_db.end(); ++iter ) {
+    values.push_back( lookup( iter->first, indicator, ext ) );
+  }
+  return values;
+}
+
+
+//**************************************************************************************************************************
+double IndicatorApp::lookup( const boost::gregorian::date& date, const std::string& indicator, const std::string& ext ) const {
+
   double value( -std::numeric_limits<double>::max() );
-  std::map< std::string, double >  thismap;
   bool found(false);
-  if ( m_indicators.find( m_iter->first ) != m_indicators.end() ) {
-    thismap = m_indicators[ m_iter->first ];
-    if( ext == "" ) { 
-      if ( thismap.find( indicator ) != thismap.end() ) {
-        value = thismap[ indicator ];
-        found = true;
-      } 
-    } 
-    else {
-      /*std::map< std::string, double >::const_iterator it = thismap.begin();
-      const std::map< std::string, double >::const_iterator eit = thismap.end();
-      for (; it != eit; ++it ){
-        std::cout << it->first << " : " << it->second << std::endl;
-      }*/
-      if ( thismap.find( indicator+"_"+ext ) != thismap.end() ) {
-        value = thismap[ indicator+"_"+ext ];
-        found = true;     
-      }     
+  const std::map< const boost::gregorian::date, std::map< std::string, double > >::const_iterator dit = m_indicators.find( date );
+  if ( dit != m_indicators.end() ) {
+    // look the value up in place, the map for a date holds every indicator and is not worth copying
+    const std::map< std::string, double >& thismap = dit->second;
+    const std::map< std::string, double >::const_iterator it = thismap.find( ext == "" ? indicator : indicator+"_"+ext );
+    if ( it != thismap.end() ) {
+      value = it->second;
+      found = true;
     }
   } else {
-    std::cerr << "WARNING: Date " << m_iter->first << " cannot be found in IndicatorApp\n";
+    std::cerr << "WARNING: Date " << date << " cannot be found in IndicatorApp\n";
   }
 
   if( !found ) {
@@ -130,7 +130,7 @@ double LongPosition::factor( EODDB::PriceType pt ) const throw(PositionException
   if( !isValid() )
     throw PositionException("Invalid position state");
 
-  return closed() ? (_avgSellPrice / _avgBuyPrice) : (Price::last(_symbol, pt) / _avgBuyPrice);
+  return closed() ? (_avgSellPrice / _avgBuyPrice) : (Price::last(series(), pt) / _avgBuyPrice);
 }
 
 
@@ -142,7 +142,7 @@ double LongPosition::factor( const boost::gregorian::date& dt, EODDB::PriceType
   if( dt <= first_exec()->dt() )
     throw PositionException("Date out of bounds");
  
-  return Price::get(_symbol, dt, pt).value() / _avgBuyPrice;
+  return Price::get(series(), dt, pt).value() / _avgBuyPrice;
 }
 
 
@@ -152,7 +152,7 @@ double LongPosition::factor( const boost::gregorian::date_period& dp, EODDB::Pri
   if( ! hold_period().contains(dp) )
     throw PositionException("Period out of range");
   
-  return Price::get(_symbol, dp.end(), pt) / Price::get(_symbol, dp.begin(), pt);
+  return Price::get(series(), dp.end(), pt) / Price::get(series(), dp.begin(), pt);
 }
 
 
@@ -176,18 +176,11 @@ double LongPosition::factor( const boost::gregorian::date::month_type& month, co
   if( first_exec()->dt() > end_mark || (closed() && last_exec()->dt() < begin_mark) )
     throw PositionException("Month out of bounds");
     
-  // Get symbol series
-  const EODSeries& db = EODDB::instance().get(_symbol);
-  
   // Extract begin of period price
   double begin_price = 0;
   // If position was opened before begin mark, then use begin_mark price (previous month last close)
   if( first_exec()->dt() <= begin_mark ) {
-    EODSeries::const_iterator citer = db.at_or_before(begin_mark);
-    if( citer == db.end() )
-      throw PositionException("Can't get begin-period price");
-      
-    begin_price = Price::get(_symbol, citer->first, pt).value();
+    begin_price = mark_price(begin_mark, pt);
 #ifdef DEBUG
     //cout << "Position opened before or at previous EOM mark price, using market " << citer->first << " price " << begin_price << endl;
 #endif
@@ -206,11 +199,7 @@ double LongPosition::factor( const boost::gregorian::date::month_type& month, co
   double end_price = 0;
   // If position is open or was closed after end-month mark, use end-month price
   if( open() || last_exec()->dt() > end_mark ) {
-    EODSeries::const_iterator citer = db.at_or_before(end_mark);
-    if( citer == db.end() )
-      throw PositionException("Can't get end-period price");
-      
-    end_price = Price::get(_symbol, citer->first, pt).value();
+    end_price = mark_price(end_mark, pt);
 #ifdef DEBUG
     //cout << "Position still open or closed after EOM mark price, using market " << citer->first << " price " << end_price << endl;
 #endif
@@ -236,11 +225,11 @@ SeriesFactorSet LongPosition::factors(Series::EODDB::PriceType pt) const throw(P
 {
 #ifdef DEBUG
   cout << "Long Position " << _id << " first exec " << first_exec()->dt() << ", last exec " << last_exec()->dt() << endl;
-  cout << "Symbol " << _symbol << " end of database: " << EODDB::instance().get(_symbol).rbegin()->first << endl;
+  cout << "Symbol " << _symbol << " end of database: " << series().rbegin()->first << endl;
   cout << "Is Position closed: " << closed() << endl;
 #endif
 
-  date last_dt = (closed() ? last_exec()->dt() : EODDB::instance().get(_symbol).rbegin()->first);
+  date last_dt = (closed() ? last_exec()->dt() : series().rbegin()->first);
 
   date_period dp(first_exec()->dt(), last_dt);
   return factors(dp, pt);
@@ -256,38 +245,5 @@ SeriesFactorSet LongPosition::factors( const boost::gregorian::date& dt, Series:
 
 SeriesFactorSet LongPosition::factors( const boost::gregorian::date_period& dp, Series::EODDB::PriceType pt ) const throw(PositionException)
 {
-  SeriesFactorSet sfs(_id);
-
-#ifdef DEBUG
-  cout << "Extracting daily factors for long position " << _id << " (" << _symbol << ") from " << dp.begin() << " to " << dp.last() << endl;
-#endif
-
-  if( ! hold_period().contains(dp) )
-    throw PositionException("Requested period is out of range");
-
-  const EODSeries& series = EODDB::instance().get(_symbol);
-
-  EODSeries::const_iterator citer = series.after(dp.begin(), 0);
-  if( citer == series.end() )
-    throw PositionException("Can't find begin of period in series");
-
-  date prev_date = citer->first;
-
-  for( EODSeries::const_iterator citer = series.after(dp.begin()); citer != series.end(); ++citer ) {
-
-    // If we're over the end of the requested period, or position is closed and we're over the last execution date, then we're done
-    if( (*citer).first > dp.last() || (closed() && (*citer).first > last_exec()->dt()) )
-      break;
-
-    double f = factor(date_period(prev_date, citer->first), pt);
-    sfs.insert(SeriesFactor(prev_date, citer->first, f));
-
-#ifdef DEBUG
-    cout << "Previous date: " << prev_date << ", current date: " << citer->first << ", factor: " << f << endl;
-#endif
-
-    prev_date = citer->first;
-  }
-
-  return sfs;
+  return daily_factors(dp, pt, false);
 }
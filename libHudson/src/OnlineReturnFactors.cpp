@@ -0,0 +1,105 @@
+/*
+* Copyright (C) 2007,2008, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StdAfx.hpp"
+
+// CSTD
+#include <cmath>
+
+// STL
+#include <algorithm>
+
+// Hudson
+#include "OnlineReturnFactors.hpp"
+
+using namespace std;
+
+
+OnlineReturnFactors::OnlineReturnFactors(void)
+{
+  clear();
+}
+
+
+void OnlineReturnFactors::add(double factor)
+{
+  // Welford/Pebay update of the central moments
+  ++_n;
+  const double n = (double)_n;
+  const double delta = factor - _mean;
+  const double delta_n = delta / n;
+  const double term = delta * delta_n * (n - 1);
+
+  _mean += delta_n;
+  _m3 += term * delta_n * (n - 2) - 3 * delta_n * _m2;
+  _m2 += term;
+
+  // Drawdown is measured from the highest compounded value before this factor
+  _log_peak = max(_log_peak, _log_fvalue);
+  _log_fvalue += ::log(factor);
+  _fvalue *= factor;
+  _log_dd = min(_log_dd, _log_fvalue - _log_peak);
+
+  _best = (_n == 1) ? factor : max(_best, factor);
+  _worst = (_n == 1) ? factor : min(_worst, factor);
+}
+
+
+void OnlineReturnFactors::clear(void)
+{
+  _n = 0;
+  _mean = 0;
+  _m2 = 0;
+  _m3 = 0;
+  _fvalue = 1;
+  _log_fvalue = 0;
+  _log_peak = 0;
+  _log_dd = 0;
+  _best = 0;
+  _worst = 0;
+}
+
+
+double OnlineReturnFactors::roi(void) const
+{
+  return _n ? _fvalue - 1 : 0;
+}
+
+
+double OnlineReturnFactors::stddev(void) const
+{
+  return _n < 2 ? 0 : ::sqrt(_m2 / (_n - 1));
+}
+
+
+double OnlineReturnFactors::skew(void) const
+{
+  // Third standardized moment using the sample standard deviation, as gsl_stats_skew_m_sd()
+  const double sd = stddev();
+  if( sd == 0 )
+    return 0;
+
+  return _m3 / (_n * ::pow(sd, 3));
+}
+
+
+double OnlineReturnFactors::dd(void) const
+{
+  return ::exp(_log_dd);
+}
@@ -0,0 +1,279 @@
+/*
+* Copyright (C) 2007,2008, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StdAfx.hpp"
+
+// CSTD
+#include <cmath>
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+
+// Hudson
+#include "PortfolioOptimizer.hpp"
+
+using namespace std;
+
+
+PortfolioOptimizer::PortfolioOptimizer( const PortfolioReturns& pr ) throw(PortfolioOptimizerException):
+  _n(pr.series()),
+  _rf_monthly(0),
+  _objective(0)
+{
+  if( _n == 0 )
+    throw PortfolioOptimizerException("Empty portfolio");
+
+  if( pr.months().size() < 2 )
+    throw PortfolioOptimizerException("Not enough monthly returns");
+
+  // Read once, every descent step then only works on these arrays
+  _vMeans = pr.means();
+  _vCovariance = pr.covariance();
+  _rf_monthly = pr.returns(0).rf_rate() / 100 / 12;
+
+  _vWeights.assign(_n, 1.0 / _n);
+}
+
+
+const vector<double>& PortfolioOptimizer::optimize( Objective obj, unsigned nStarts, unsigned nThreads, unsigned long seed )
+{
+  nStarts = max(nStarts, 1u);
+  if( nThreads == 0 )
+    nThreads = max(thread::hardware_concurrency(), 1u);
+  nThreads = min(nThreads, nStarts);
+
+  // Starting points: equal weights, then uniform random weights on the simplex
+  vector< vector<double> > vStarts(nStarts, vector<double>(_n, 1.0 / _n));
+  mt19937_64 rng(seed);
+  exponential_distribution<double> expo(1.0);
+  for( unsigned s = 1; s < nStarts; ++s ) {
+    double acc = 0;
+    for( size_t i = 0; i < _n; ++i )
+      acc += (vStarts[s][i] = expo(rng));
+    for( size_t i = 0; i < _n; ++i )
+      vStarts[s][i] /= acc;
+  }
+
+  vector<double> vValues(nStarts, numeric_limits<double>::infinity());
+  atomic<unsigned> next(0);
+
+  vector<thread> vThreads;
+  for( unsigned t = 0; t < nThreads; ++t ) {
+    vThreads.push_back(thread([&]() {
+      unsigned s;
+      while( (s = next++) < nStarts )
+        vValues[s] = _descend(obj, vStarts[s]);
+    }));
+  }
+
+  for( size_t t = 0; t < vThreads.size(); ++t )
+    vThreads[t].join();
+
+  const unsigned best = (unsigned)(min_element(vValues.begin(), vValues.end()) - vValues.begin());
+  _vWeights = _weights(obj, vStarts[best]);
+  _objective = vValues[best];
+
+  return _vWeights;
+}
+
+
+double PortfolioOptimizer::variance( const vector<double>& w ) const
+{
+  double var = 0;
+  for( size_t i = 0; i < _n; ++i )
+    var += w[i] * inner_product(w.begin(), w.begin() + _n, _vCovariance.begin() + i * _n, 0.0);
+
+  return var;
+}
+
+
+double PortfolioOptimizer::sharpe( const vector<double>& w ) const
+{
+  const double var = variance(w);
+  if( var <= 0 )
+    return 0;
+
+  const double mean = inner_product(w.begin(), w.begin() + _n, _vMeans.begin(), 0.0);
+  return ((mean * 12.0) - (_rf_monthly * 12.0)) / (::sqrt(var) * ::sqrt((double)12.0));
+}
+
+
+string PortfolioOptimizer::objective_str( Objective obj )
+{
+  switch( obj ) {
+    case MAX_SHARPE:   return "sharpe";
+    case MIN_VARIANCE: return "minvar";
+    case RISK_PARITY:  return "parity";
+  }
+
+  return "";
+}
+
+
+PortfolioOptimizer::Objective PortfolioOptimizer::objective_from_str( const string& name ) throw(PortfolioOptimizerException)
+{
+  if( name == "sharpe" )
+    return MAX_SHARPE;
+  if( name == "minvar" )
+    return MIN_VARIANCE;
+  if( name == "parity" )
+    return RISK_PARITY;
+
+  throw PortfolioOptimizerException("Unknown objective " + name);
+}
+
+
+double PortfolioOptimizer::_value( Objective obj, const vector<double>& x, vector<double>& grad ) const
+{
+  // C x, shared by all objectives
+  vector<double> cx(_n);
+  for( size_t i = 0; i < _n; ++i )
+    cx[i] = inner_product(x.begin(), x.end(), _vCovariance.begin() + i * _n, 0.0);
+
+  const double var = inner_product(x.begin(), x.end(), cx.begin(), 0.0);
+  grad.resize(_n);
+
+  switch( obj ) {
+
+    case MIN_VARIANCE:
+      for( size_t i = 0; i < _n; ++i )
+        grad[i] = 2 * cx[i];
+      return var;
+
+    case MAX_SHARPE: {
+      // Minimize -(mean - rf) / sd
+      if( var <= 0 ) {
+        fill(grad.begin(), grad.end(), 0);
+        return 0;
+      }
+      const double sd = ::sqrt(var);
+      const double excess = inner_product(x.begin(), x.end(), _vMeans.begin(), 0.0) - _rf_monthly;
+      for( size_t i = 0; i < _n; ++i )
+        grad[i] = -(_vMeans[i] / sd - excess * cx[i] / (var * sd));
+      return -excess / sd;
+    }
+
+    case RISK_PARITY: {
+      double log_acc = 0;
+      for( size_t i = 0; i < _n; ++i ) {
+        grad[i] = cx[i] - 1.0 / (_n * x[i]);
+        log_acc += ::log(x[i]);
+      }
+      return 0.5 * var - log_acc / _n;
+    }
+  }
+
+  return 0;
+}
+
+
+void PortfolioOptimizer::_project( Objective obj, vector<double>& x ) const
+{
+  if( obj == RISK_PARITY ) {
+    // Positive orthant, kept away from 0 for the log barrier
+    for( size_t i = 0; i < _n; ++i )
+      x[i] = max(x[i], 1e-12);
+    return;
+  }
+
+  // Euclidean projection on the simplex: shift all coordinates by the same amount and clip at 0
+  vector<double> u(x);
+  sort(u.begin(), u.end(), greater<double>());
+
+  double acc = 0, theta = 0;
+  for( size_t j = 0; j < _n; ++j ) {
+    acc += u[j];
+    const double t = (acc - 1) / (j + 1);
+    if( u[j] - t > 0 )
+      theta = t;
+  }
+
+  for( size_t i = 0; i < _n; ++i )
+    x[i] = max(x[i] - theta, 0.0);
+}
+
+
+double PortfolioOptimizer::_descend( Objective obj, vector<double>& x ) const
+{
+  _project(obj, x);
+
+  vector<double> grad, next_grad, next(_n);
+  double f = _value(obj, x, grad);
+  double step = 1;
+
+  for( unsigned iter = 0; iter < MAX_ITERATIONS; ++iter ) {
+
+    // Backtrack until the projected step decreases f below its quadratic upper bound
+    double next_f = f, dist2 = 0;
+    bool accepted = false;
+    while( step > 1e-20 ) {
+      for( size_t i = 0; i < _n; ++i )
+        next[i] = x[i] - step * grad[i];
+      _project(obj, next);
+
+      double decrease = 0;
+      dist2 = 0;
+      for( size_t i = 0; i < _n; ++i ) {
+        decrease += grad[i] * (next[i] - x[i]);
+        dist2 += (next[i] - x[i]) * (next[i] - x[i]);
+      }
+
+      next_f = _value(obj, next, next_grad);
+      if( next_f <= f + decrease + dist2 / (2 * step) ) {
+        accepted = true;
+        break;
+      }
+      step /= 2;
+    }
+
+    if( !accepted )
+      break;
+
+    x.swap(next);
+    grad.swap(next_grad);
+    const double change = f - next_f;
+    f = next_f;
+
+    if( dist2 < 1e-24 || ::fabs(change) < 1e-15 * (1 + ::fabs(f)) )
+      break;
+
+    step *= 2;
+  }
+
+  return f;
+}
+
+
+vector<double> PortfolioOptimizer::_weights( Objective obj, const vector<double>& x ) const
+{
+  vector<double> w(x);
+  if( obj == RISK_PARITY ) {
+    const double acc = accumulate(w.begin(), w.end(), 0.0);
+    for( size_t i = 0; i < _n; ++i )
+      w[i] /= acc;
+  }
+
+  return w;
+}
@@ -21,6 +21,7 @@
 
 // STL
 #include <iostream>
+#include <sstream>
 
 // Hudson
 #include "PortfolioReport.hpp"
@@ -51,3 +52,36 @@ void PortfolioReport::print(void)
   cout.precision(curr_precision);
   cout.flags(curr_flags);
 }
+
+
+void PortfolioReport::weights(void) const
+{
+  streamsize curr_precision = cout.precision();
+  ios_base::fmtflags curr_flags = cout.flags();
+
+  cout.precision(2);
+  cout.setf(ios::fixed);
+
+  cout << "Weights:";
+  for( unsigned i = 0; i < _pr.series(); ++i )
+    cout << ' ' << _pr.weight(i)*100 << '%';
+  cout << endl;
+
+  cout.precision(curr_precision);
+  cout.flags(curr_flags);
+}
+
+
+void PortfolioReport::fill(ReportTable& table, const std::string& prefix) const
+{
+  table.set(prefix + "roi", _pr.roi());
+  table.set(prefix + "cagr", _pr.cagr());
+  table.set(prefix + "gsdm", _pr.gsd());
+  table.set(prefix + "sharpe", _pr.sharpe());
+
+  for( unsigned i = 0; i < _pr.series(); ++i ) {
+    ostringstream name;
+    name << prefix << "weight_" << i;
+    table.set(name.str(), _pr.weight(i));
+  }
+}
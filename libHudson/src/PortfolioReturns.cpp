@@ -19,14 +19,25 @@
 
 #include "StdAfx.hpp"
 
+// CSTD
+#include <cmath>
+
+// STL
+#include <algorithm>
+
 // Hudson
 #include "PortfolioReturns.hpp"
 
 using namespace std;
+using namespace boost::gregorian;
 
 
 PortfolioReturns::PortfolioReturns( void ):
-  _accWeight(0)
+  _accWeight(0),
+  _fvalue(1),
+  _mmean(1),
+  _mstddev(0),
+  _lfstddev(0)
 {
 }
 
@@ -44,6 +55,33 @@ void PortfolioReturns::add( EOMReturnFactors* rf, double weight) throw(Portfolio
   EOMRFWeight rfw(rf, weight);
     
   _vRF.push_back(rfw);
+
+  _buildMatrix();
+  _aggregate();
+}
+
+
+void PortfolioReturns::setWeights( const vector<double>& weights ) throw(PortfolioReturnsException)
+{
+  if( weights.size() != _vRF.size() )
+    throw PortfolioReturnsException("Number of weights does not match number of EOM return factors");
+
+  double accWeight = 0;
+  for( size_t i = 0; i < weights.size(); ++i ) {
+    if( weights[i] < 0 )
+      throw PortfolioReturnsException("Invalid EOM return factors weight");
+    accWeight += weights[i];
+  }
+
+  // Allow for rounding in weights computed to sum to 1
+  if( accWeight > 1 + 1e-9 )
+    throw PortfolioReturnsException("EOM return factors weight exceeding portfolio size");
+
+  for( size_t i = 0; i < weights.size(); ++i )
+    _vRF[i].w = weights[i];
+  _accWeight = accWeight;
+
+  _aggregate();
 }
 
 
@@ -52,24 +90,16 @@ double PortfolioReturns::roi( void ) const
   if( _vRF.empty() )
     return 0;
 
-  double acc_cagr = 0;
-  for( size_t i = 0; i < _vRF.size(); ++i )
-    acc_cagr += (_vRF[i].pEOMRF->roi() * (_accWeight ? _vRF[i].w : 1));
-
-  return acc_cagr / (_accWeight ? 1 : _vRF.size());
+  return _fvalue - 1;
 }
 
 
 double PortfolioReturns::cagr( void ) const
 {
-  if( _vRF.empty() )
+  if( _vRF.empty() || _vMonths.empty() )
     return 0;
 
-  double acc_cagr = 0;
-  for( size_t i = 0; i < _vRF.size(); ++i )
-    acc_cagr += (_vRF[i].pEOMRF->cagr() * (_accWeight ? _vRF[i].w : 1));
-
-  return acc_cagr / (_accWeight ? 1 : _vRF.size());
+  return ::pow(_fvalue, 12 / (double)_vMonths.size()) - 1;
 }
 
 
@@ -78,24 +108,151 @@ double PortfolioReturns::gsd( void ) const
   if( _vRF.empty() )
     return 0;
 
-  double acc_cagr = 0;
-  for( size_t i = 0; i < _vRF.size(); ++i )
-    acc_cagr += (_vRF[i].pEOMRF->gsd() * (_accWeight ? _vRF[i].w : 1));
-
-  return acc_cagr / (_accWeight ? 1 : _vRF.size());
+  return ::pow( (double)10, _lfstddev * ::sqrt((double)12) ) - 1;
 }
 
 
 double PortfolioReturns::sharpe( void ) const
 {
-  if( _vRF.empty() )
+  if( _vRF.empty() || _mstddev == 0 )
     return 0;
 
-  double acc_sharpe = 0;
-  for( size_t i = 0; i < _vRF.size(); ++i )
-    acc_sharpe += (_vRF[i].pEOMRF->sharpe() * (_accWeight ? _vRF[i].w : 1));
+  const double rf_rate = _vRF.front().pEOMRF->rf_rate();
+  return (((_mmean-1.0)*12.0) - (rf_rate/100.0)) / (_mstddev*::sqrt((double)12.0));
+}
+
+
+const vector<double>& PortfolioReturns::means( void ) const
+{
+  if( _vMeans.size() == _vRF.size() )
+    return _vMeans;
+
+  const size_t nMonths = _vMonths.size();
+  _vMeans.assign(_vRF.size(), 0);
+  for( size_t i = 0; i < _vRF.size() && nMonths; ++i ) {
+    const double* row = &_vReturns[i * nMonths];
+    double acc = 0;
+    for( size_t m = 0; m < nMonths; ++m )
+      acc += row[m];
+    _vMeans[i] = acc / nMonths;
+  }
+
+  return _vMeans;
+}
+
+
+const vector<double>& PortfolioReturns::covariance( void ) const
+{
+  const size_t n = _vRF.size();
+  if( _vCovariance.size() == n * n )
+    return _vCovariance;
+
+  const size_t nMonths = _vMonths.size();
+  _vCovariance.assign(n * n, 0);
+  if( nMonths < 2 )
+    return _vCovariance;
+
+  const vector<double>& vMeans = means();
+
+  // Demeaned return rows, every covariance is then a dot product of two contiguous rows
+  vector<double> vDemeaned(_vReturns.size());
+  for( size_t i = 0; i < n; ++i )
+    for( size_t m = 0; m < nMonths; ++m )
+      vDemeaned[i * nMonths + m] = _vReturns[i * nMonths + m] - vMeans[i];
+
+  for( size_t i = 0; i < n; ++i ) {
+    const double* row_i = &vDemeaned[i * nMonths];
+    for( size_t j = i; j < n; ++j ) {
+      const double* row_j = &vDemeaned[j * nMonths];
+      double acc = 0;
+      for( size_t m = 0; m < nMonths; ++m )
+        acc += row_i[m] * row_j[m];
+
+      _vCovariance[i * n + j] = _vCovariance[j * n + i] = acc / (nMonths - 1);
+    }
+  }
+
+  return _vCovariance;
+}
+
+
+void PortfolioReturns::_buildMatrix( void )
+{
+  // Union of all end-of-month dates
+  vector<date> vMonths;
+  for( size_t i = 0; i < _vRF.size(); ++i ) {
+    const EOMReturnFactors::DATEMFACTOR& mfactors = _vRF[i].pEOMRF->mfactors();
+    for( EOMReturnFactors::DATEMFACTOR::const_iterator citer = mfactors.begin(); citer != mfactors.end(); ++citer )
+      vMonths.push_back(citer->first);
+  }
+
+  sort(vMonths.begin(), vMonths.end());
+  vMonths.erase(unique(vMonths.begin(), vMonths.end()), vMonths.end());
+  _vMonths.swap(vMonths);
+
+  // One row of monthly returns per component, merging its months with the union
+  const size_t nMonths = _vMonths.size();
+  _vReturns.assign(_vRF.size() * nMonths, 0);
+  for( size_t i = 0; i < _vRF.size(); ++i ) {
+    const EOMReturnFactors::DATEMFACTOR& mfactors = _vRF[i].pEOMRF->mfactors();
+    EOMReturnFactors::DATEMFACTOR::const_iterator citer = mfactors.begin();
+    for( size_t m = 0; m < nMonths && citer != mfactors.end(); ++m ) {
+      if( citer->first != _vMonths[m] )
+        continue;
+
+      _vReturns[i * nMonths + m] = citer->second - 1;
+      ++citer;
+    }
+  }
+
+  _vMeans.clear();
+  _vCovariance.clear();
+}
+
+
+void PortfolioReturns::_aggregate( void )
+{
+  const size_t nMonths = _vMonths.size();
+
+  // Weighted sum of the return rows, unallocated weight is flat
+  _vMFactors.assign(nMonths, 1);
+  for( size_t i = 0; i < _vRF.size(); ++i ) {
+    const double w = weight((unsigned)i);
+    if( w == 0 || !nMonths )
+      continue;
+
+    const double* row = &_vReturns[i * nMonths];
+    for( size_t m = 0; m < nMonths; ++m )
+      _vMFactors[m] += w * row[m];
+  }
+
+  _fvalue = 1;
+  _mmean = 1;
+  _mstddev = 0;
+  _lfstddev = 0;
+  if( _vMFactors.empty() )
+    return;
+
+  double acc = 0, lacc = 0;
+  for( size_t m = 0; m < nMonths; ++m ) {
+    _fvalue *= _vMFactors[m];
+    acc += _vMFactors[m];
+    lacc += ::log10(_vMFactors[m]);
+  }
+
+  _mmean = acc / nMonths;
+  if( nMonths < 2 )
+    return;
+
+  const double lfavg = lacc / nMonths;
+  double var_acc = 0, lvar_acc = 0;
+  for( size_t m = 0; m < nMonths; ++m ) {
+    var_acc += ::pow(_vMFactors[m] - _mmean, 2);
+    lvar_acc += ::pow(::log10(_vMFactors[m]) - lfavg, 2);
+  }
 
-  return acc_sharpe / (_accWeight ? 1 : _vRF.size());
+  _mstddev = ::sqrt(var_acc / (nMonths - 1));
+  _lfstddev = ::sqrt(lvar_acc / (nMonths - 1));
 }
 
 
@@ -22,11 +22,13 @@
 // STL
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 // Hudson
 #include "Price.hpp"
 #include "Position.hpp"
 #include "EODDB.hpp"
+#include "SeriesFactorSet.hpp"
 
 using namespace std;
 using namespace boost::gregorian;
@@ -36,18 +38,28 @@ using namespace Series;
 Position::Position(ID id, const string& symbol):
   _id(id),
   _symbol(symbol),
-  _size(0)
+  _size(0),
+  _pSeries(0)
 {
 }
 
 
+const Series::EODSeries& Position::series(void) const
+{
+  if( _pSeries == 0 )
+    _pSeries = &EODDB::instance().get(_symbol);
+
+  return *_pSeries;
+}
+
+
 void Position::print(void) const
 {
   cout << _symbol << ":";
   _sExecutions.print();
   
   if( open() )
-    cout << " (" << Series::EODDB::instance().get(_symbol).last().adjclose << ") ";
+    cout << " (" << series().last().adjclose << ") ";
     
   cout << " - " << "Factor " << factor() << " (" << (factor()-1)*100 << "%)";
 }
@@ -60,5 +72,58 @@ boost::gregorian::date_period Position::hold_period( void ) const throw(Position
     
   return (closed() ?
             boost::gregorian::date_period(_sExecutions.first_by_date()->dt(), _sExecutions.last_by_date()->dt()) :
-              boost::gregorian::date_period(_sExecutions.first_by_date()->dt(), Series::EODDB::instance().get(_symbol).rbegin()->first));
+              boost::gregorian::date_period(_sExecutions.first_by_date()->dt(), series().rbegin()->first));
+}
+
+
+double Position::mark_price( const boost::gregorian::date& mark, Series::EODDB::PriceType pt ) const throw(PositionException)
+{
+  const size_t row = series().row_at_or_before(mark);
+  if( row == Series::EODSeries::npos ) {
+    stringstream ss;
+    ss << "Can't get " << mark << " mark price";
+    throw PositionException(ss.str());
+  }
+
+  try {
+    return Price::get(series(), row, pt).value();
+  } catch( const exception& ex ) {
+    throw PositionException(ex.what());
+  }
+}
+
+
+SeriesFactorSet Position::daily_factors( const boost::gregorian::date_period& dp, Series::EODDB::PriceType pt, bool inverse ) const throw(PositionException)
+{
+  SeriesFactorSet sfs(_id);
+
+  if( ! hold_period().contains(dp) )
+    throw PositionException("Requested period is out of range");
+
+  // Resolve the series and the row range once, every daily period is then within the holding period
+  const vector<date>& dates = series().dates();
+  const vector<double>* prices = 0;
+  try {
+    prices = &Price::column(series(), pt);
+  } catch( const exception& ex ) {
+    throw PositionException(ex.what());
+  }
+
+  date last_dt = dp.last();
+  if( closed() && last_exec()->dt() < last_dt )
+    last_dt = last_exec()->dt();
+
+  const size_t first = lower_bound(dates.begin(), dates.end(), dp.begin()) - dates.begin();
+  if( first == dates.size() )
+    throw PositionException("Can't find begin of period in series");
+
+  const size_t end = upper_bound(dates.begin() + first, dates.end(), last_dt) - dates.begin();
+
+  for( size_t i = first + 1; i < end; ++i ) {
+    const Price begin_price((*prices)[i-1]);
+    const Price end_price((*prices)[i]);
+    sfs.insert(SeriesFactor(dates[i-1], dates[i], inverse ? begin_price / end_price : end_price / begin_price));
+  }
+
+  return sfs;
 }
@@ -0,0 +1,162 @@
+/*
+* Copyright (C) 2007,2008, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StdAfx.hpp"
+
+// STL
+#include <algorithm>
+
+// Hudson
+#include "PositionFactorCache.hpp"
+#include "SeriesFactorSet.hpp"
+
+using namespace std;
+using namespace Series;
+
+
+PositionFactorCache::PositionFactorCache(void):
+  _prune_size(1024)
+{
+}
+
+
+PositionFactorCache::~PositionFactorCache(void)
+{
+  clear();
+}
+
+
+PositionFactorCache& PositionFactorCache::instance(void)
+{
+  // Local static, initialized once even if the first calls come from concurrent backtests
+  static PositionFactorCache cache;
+  return cache;
+}
+
+
+PositionFactorCache::FactorsPtr PositionFactorCache::factors( const PositionPtr& pPos, EODDB::PriceType pt ) throw(PositionException)
+{
+  const Position::ID id = pPos->id();
+  unsigned long generation = 0;
+
+  {
+    lock_guard<mutex> lock(_mutex);
+
+    Entry& entry = _mEntries[id];
+    if( entry.wpPos.lock() == pPos ) {
+      map<EODDB::PriceType, FactorsPtr>::const_iterator fiter = entry.mFactors.find(pt);
+      if( fiter != entry.mFactors.end() )
+        return fiter->second;
+
+    } else {
+      // New entry, or a stale one left by a Position constructed with a reused id. The Watch is
+      // attached before computing, so an execution during the computation is seen.
+      if( entry.pWatch ) {
+        PositionPtr pOld = entry.wpPos.lock();
+        if( pOld ) pOld->detach(entry.pWatch.get());
+        entry.pWatch.reset();
+      }
+      entry.mFactors.clear();
+      entry.wpPos = pPos;
+      ++entry.generation;
+
+      if( pPos->type() != Position::STRATEGY ) {
+        entry.pWatch.reset(new Watch(*this, id));
+        pPos->attach(entry.pWatch.get());
+      }
+    }
+
+    generation = entry.generation;
+  }
+
+  // Compute outside the lock, other positions can be served meanwhile. Copy factors in to_tm order,
+  // keeping one factor per to_tm date.
+  SeriesFactorSet sfsAll = pPos->factors(pt);
+  boost::shared_ptr<FACTORS> pFactors(new FACTORS);
+  pFactors->reserve(sfsAll.size());
+
+  const SeriesFactorSet::by_to& sfsByTo = sfsAll.get<to_key>();
+  for( SeriesFactorSet::by_to::const_iterator citer = sfsByTo.begin(); citer != sfsByTo.end(); ++citer ) {
+    if( !pFactors->empty() && pFactors->back().to_tm() == (*citer).to_tm() )
+      continue;
+    pFactors->push_back(*citer);
+  }
+
+  lock_guard<mutex> lock(_mutex);
+
+  // Keep the factors only if the entry was not invalidated or cleared while they were computed
+  ENTRIES::iterator eiter = _mEntries.find(id);
+  if( eiter != _mEntries.end() && eiter->second.generation == generation && eiter->second.wpPos.lock() == pPos )
+    eiter->second.mFactors[pt] = pFactors;
+
+  if( _mEntries.size() > _prune_size )
+    _prune();
+
+  return pFactors;
+}
+
+
+void PositionFactorCache::invalidate( Position::ID id )
+{
+  // Called from Watch::update() while the Position notifies its observers: only drop the factors,
+  // the Watch stays attached. The new generation keeps factors computed meanwhile out of the cache.
+  lock_guard<mutex> lock(_mutex);
+
+  ENTRIES::iterator iter = _mEntries.find(id);
+  if( iter != _mEntries.end() ) {
+    iter->second.mFactors.clear();
+    ++iter->second.generation;
+  }
+}
+
+
+void PositionFactorCache::clear(void)
+{
+  lock_guard<mutex> lock(_mutex);
+
+  for( ENTRIES::iterator iter = _mEntries.begin(); iter != _mEntries.end(); ++iter ) {
+    PositionPtr pPos = iter->second.wpPos.lock();
+    if( pPos && iter->second.pWatch )
+      pPos->detach(iter->second.pWatch.get());
+  }
+
+  _mEntries.clear();
+  _prune_size = 1024;
+}
+
+
+std::size_t PositionFactorCache::size(void) const
+{
+  lock_guard<mutex> lock(_mutex);
+  return _mEntries.size();
+}
+
+
+void PositionFactorCache::_prune(void)
+{
+  for( ENTRIES::iterator iter = _mEntries.begin(); iter != _mEntries.end(); ) {
+    if( iter->second.wpPos.expired() )
+      _mEntries.erase(iter++);
+    else
+      ++iter;
+  }
+
+  // Live entries stay, grow the limit so pruning remains amortized
+  _prune_size = std::max<std::size_t>(1024, _mEntries.size() * 2);
+}
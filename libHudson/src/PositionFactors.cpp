@@ -38,236 +38,135 @@ using namespace Series;
 
 PositionFactors::PositionFactors( const PositionPtr pPos, Series::EODDB::PriceType pt ):
   _pPos(pPos),
-  _pt(pt)
+  _pt(pt),
+  _pFactors(PositionFactorCache::instance().factors(pPos, pt)),
+  _vFactors(*_pFactors)
 {
-  SeriesFactorSet sfsAll = _pPos->factors(pt);
-
-  for( SeriesFactorSet::const_iterator citer = sfsAll.begin(); citer != sfsAll.end(); ++citer ) {
-    // Initialize SeriesFactorSet objects indexed both by from_time and to_time to calculate bfe() and wae().
-    // This is for performance reasons. SeriesFactorSet multi_index secondary key access is much slower than primary key.
-    _sf_fromtm.insert(*citer);
-    _sf_totm.insert(*citer);
-  }
+  // bfe()/wae() and the consecutive runs are single passes over the cached factors
 }
 
 
 SeriesFactorSet PositionFactors::max_cons_pos(void) const
 {
-  SeriesFactorSet maxSFS(_pPos->id());
+  SF_ROWS::size_type first = 0, last = 0;
+  if( !_run(true, first, last) )
+    return SeriesFactorSet(_pPos->id());
 
-  SF_TOTM::const_iterator iter = _sf_totm.begin();
-  while( iter != _sf_totm.end() ) {
-    // Skip negative factors
-    if( (*iter).factor() <= 1 ) {
-      ++iter;
-      continue;
-    }
+  return _rows(first, last);
+}
 
-    // Positive factor, look for positive sequence
-    SeriesFactorSet sfset(_pPos->id());
-    while( iter != _sf_totm.end() && (*iter).factor() > 1 ) {
-      sfset.insert(*iter);
-      ++iter;
-    }
 
-    // Store new last consecutive-positive if better than previous one
-    if( sfset.size() > maxSFS.size() )
-      maxSFS = sfset;
-  }
+SeriesFactorSet PositionFactors::max_cons_neg(void) const
+{
+  SF_ROWS::size_type first = 0, last = 0;
+  if( !_run(false, first, last) )
+    return SeriesFactorSet(_pPos->id());
 
-  return maxSFS;
+  return _rows(first, last);
 }
 
 
-SeriesFactorSet PositionFactors::max_cons_neg(void) const
+bool PositionFactors::_run( bool positive, SF_ROWS::size_type& first, SF_ROWS::size_type& last ) const
 {
-  SeriesFactorSet maxSFS(_pPos->id());
-
-  SF_TOTM::const_iterator iter = _sf_totm.begin();
-  while ( iter != _sf_totm.end() ) {
-    if( (*iter).factor() >= 1 ) {
-      ++iter;
+  // Longest sequence of consecutive factors > 1 (or < 1). On equal length the earliest one wins.
+  bool found = false;
+  SF_ROWS::size_type start = 0;
+  for( SF_ROWS::size_type i = 0; i < _vFactors.size(); ++i ) {
+    const double f = _vFactors[i].factor();
+    if( positive ? f <= 1 : f >= 1 ) {
+      start = i + 1;
       continue;
     }
 
-    // Negative factor, look for negative sequence
-    SeriesFactorSet sfset(_pPos->id());
-    while( iter != _sf_totm.end() && (*iter).factor() < 1 ) {
-      sfset.insert(*iter);
-      ++iter;
+    if( !found || i - start > last - first ) {
+      first = start;
+      last = i;
+      found = true;
     }
-
-    // Store new last consecutive-negative if better than previous one
-    if( sfset.size() > maxSFS.size() )
-      maxSFS = sfset;
   }
 
-  return maxSFS;
+  return found;
 }
 
 
 SeriesFactorSet PositionFactors::wae( void ) const throw(PositionFactorsException)
 {
-  // Look for position worst excursion starting from each entry in position daily series
-
-  PeriodFactor worst_pf; // Worst found so far
-  bool never_set = true; // Whether worst found has been set once already
-
-  // For each SeriesFactor bar
-  for( SF_TOTM::const_iterator iter = _sf_totm.begin(); iter != _sf_totm.end(); ++iter ) {
-
-    // Calculate worst adverse excursion from this point to the end
-    PeriodFactor pf = _wae(iter); // return drawdown from this bar
-
-    // Compate last worst adverse excursion to previous set
-    if( never_set || pf.factor < worst_pf.factor ) {
-      worst_pf = pf;
-      never_set = false;
-#ifdef DEBUG
-      cout << "WAE set from " << worst_pf.from_tm << " to " << worst_pf.to_tm << " (" << worst_pf.factor << ")" << endl;
-#endif
-    }
-  }
-
-  if( never_set )
+  SF_ROWS::size_type first = 0, last = 0;
+  if( !_excursion(true, first, last) )
     return SeriesFactorSet(_pPos->id()); // Return empty set
 
-  if( !worst_pf.isValid() ) {
+  if( _vFactors[first].from_tm().is_not_a_date() || _vFactors[last].to_tm().is_not_a_date() ) {
     stringstream ss;
     ss << "Can't get position " << _pPos->id() << " worst adverse excursion period";
     throw PositionFactorsException(ss.str());
   }
 
 #ifdef DEBUG
-  //cout << "Found worst excursion from " << worst_pf.from_tm << " to " << worst_pf.to_tm << endl;
-#endif
-
-  // Locate beginning of stored worst adverse excursion in SeriesFactor set
-  SeriesFactor sf(worst_pf.from_tm, worst_pf.to_tm, worst_pf.factor);
-  SF_FROMTM::const_iterator src_begin = _sf_fromtm.find(sf);
-  if( src_begin == _sf_fromtm.end() ) {
-    stringstream ss;
-    ss << "Can't get position " << _pPos->id() << " beginning of worst adverse excursion period" << endl;
-    throw PositionFactorsException(ss.str());
-  }
-
-  // Initialize a new SeriesFactorSet with SeriesFactor included in worst_pf range
-  SeriesFactorSet sfs(_pPos->id());
-#ifdef DEBUG
-  //cout << "Adding SeriesFactor from " << (*src_begin).from_tm() << " to " << worst_pf.to_tm << endl;
+  cout << "WAE set from " << _vFactors[first].from_tm() << " to " << _vFactors[last].to_tm() << endl;
 #endif
-  for( SF_FROMTM::const_iterator iter(src_begin); iter != _sf_fromtm.end() && (*iter).to_tm() <= worst_pf.to_tm; ++iter )
-    sfs.insert(*iter);
 
-  return sfs; // Return worst drawdown series factor set for this position
-}
-
-
-PositionFactors::PeriodFactor PositionFactors::_wae(SF_TOTM::const_iterator& start) const
-{
-  // Return value defaults
-  PeriodFactor pf;
-  pf.from_tm = (*start).from_tm(); // Begin of excursion analysis
-
-  // Calculate worst excursion from 'start'.
-  SeriesFactorSet sfs(_pPos->id());
-  bool never_set = true;
-  for( SF_TOTM::const_iterator iter = start; iter != _sf_totm.end(); ++iter ) {
-
-    sfs.insert(*iter); // current position factors series
-
-    // Check lower excursion
-    if( never_set || sfs.factor() < pf.factor ) {
-      // Store lower excursion
-      pf.factor = sfs.factor();
-      pf.to_tm = (*iter).to_tm();
-      never_set = false;
-    }
-  }
-
-  // Return worst drawdown factor including begin/end time marks
-  return pf;
+  return _rows(first, last); // Return worst drawdown series factor set for this position
 }
 
 
 SeriesFactorSet PositionFactors::bfe(void) const throw(PositionFactorsException)
 {
-  // Look for worst position excursion period starting from each entry in daily series
-
-  // For each SeriesFactor bar
-  PeriodFactor best_pf;
-  bool never_set = true;
-  for( SF_TOTM::const_iterator iter = _sf_totm.begin(); iter != _sf_totm.end(); ++iter ) {
-
-    // Calculate best favorable excursion from this point
-    PeriodFactor pf = _bfe(iter); // return best favorable excursion from this bar
-
-    // Store best favorable excursion till now
-    if( never_set || pf.factor > best_pf.factor ) {
-      best_pf = pf;
-      never_set = false;
-    }
-  }
-
-  if( never_set )
+  SF_ROWS::size_type first = 0, last = 0;
+  if( !_excursion(false, first, last) )
     return SeriesFactorSet(_pPos->id());
 
-  if( !best_pf.isValid() ) {
+  if( _vFactors[first].from_tm().is_not_a_date() || _vFactors[last].to_tm().is_not_a_date() ) {
     stringstream ss;
     ss << "Can't get position " << _pPos->id() << " best favorable excursion period";
     throw PositionFactorsException(ss.str());
   }
 
-  // Locate beginning of stored best excursion
-  SeriesFactor sf(best_pf.from_tm, best_pf.to_tm, best_pf.factor);
-  SF_FROMTM::const_iterator src_begin = _sf_fromtm.find(sf);
-  if( src_begin == _sf_fromtm.end() ) {
-    stringstream ss;
-    ss << "Can't get position " << _pPos->id() << " beginning of best favorable excursion period" << endl;
-    throw PositionFactorsException(ss.str());
-  }
-
-  // Initialize SeriesFactorSet with SeriesFactor(s) included in best_pf range
-  SeriesFactorSet sfs(_pPos->id());
-  for( SF_FROMTM::const_iterator iter(src_begin); (*iter).to_tm() <= best_pf.to_tm && iter != _sf_fromtm.end(); ++iter )
-    sfs.insert(*iter);
-
-  return sfs; // Return worst drawdown for this position
+  return _rows(first, last); // Return best favorable excursion for this position
 }
 
 
-PositionFactors::PeriodFactor PositionFactors::_bfe(SF_TOTM::const_iterator& start) const
+bool PositionFactors::_excursion( bool worst, SF_ROWS::size_type& first, SF_ROWS::size_type& last ) const
 {
-  // Return value defaults
-  PeriodFactor pf;
-  pf.from_tm = (*start).from_tm(); // Begin of excursion no matter what
+  if( _vFactors.empty() )
+    return false;
 
-  // Calculate best excursion from 'start'. We can't use multi_index secondary index for performance reasons.
-  SeriesFactorSet sfs(_pPos->id());
-  bool never_set = true;
-  for( SF_TOTM::const_iterator iter = start; iter != _sf_totm.end(); ++iter ) {
-    sfs.insert(*iter);
-
-    // Check higher excursion
-    if( never_set || sfs.factor() > pf.factor ) {
-      // Store higher excursion
-      pf.factor = sfs.factor();
-      pf.to_tm = (*iter).to_tm();
-      never_set = false;
+  // With L(k) the cumulative log-factor before row k, the excursion over rows [i, j] is
+  // L(j+1) - L(i). Scanning j once while keeping the highest L(i) seen so far (lowest for the
+  // best excursion) gives the worst (best) excursion ending at every row. Ties keep the earliest
+  // start and end rows.
+  const double sign = worst ? -1 : 1;
+
+  double cum = 0;          // L(j)
+  double start_cum = 0;    // Most favorable L(i), i <= j
+  SF_ROWS::size_type start = 0;
+  double extreme = 0;
+
+  for( SF_ROWS::size_type j = 0; j < _vFactors.size(); ++j ) {
+
+    if( sign * cum < sign * start_cum ) {
+      start_cum = cum;
+      start = j;
     }
-  }
 
-  return pf;
-}
+    cum += log(_vFactors[j].factor());
 
+    const double excursion = sign * (cum - start_cum);
+    if( j == 0 || excursion > extreme ) {
+      extreme = excursion;
+      first = start;
+      last = j;
+    }
+  }
 
-PositionFactors::PeriodFactor::PeriodFactor( double f ):
-  factor(f)
-{
+  return true;
 }
 
 
-bool PositionFactors::PeriodFactor::isValid( void ) const
+SeriesFactorSet PositionFactors::_rows( SF_ROWS::size_type first, SF_ROWS::size_type last ) const
 {
-  return (from_tm.is_not_a_date() || to_tm.is_not_a_date()) ? false : true;
+  SeriesFactorSet sfs(_pPos->id());
+  for( SF_ROWS::size_type i = first; i <= last && i < _vFactors.size(); ++i )
+    sfs.insert(_vFactors[i]);
+
+  return sfs;
 }
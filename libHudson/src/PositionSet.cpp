@@ -39,13 +39,23 @@ void PositionSet::print(void) const
 }
 
 
+PositionSet::symbol_closed_view PositionSet::closedView( const std::string& symbol ) const
+{
+  return symbol_closed_view(get<symbol_key>().lower_bound(symbol), get<symbol_key>().upper_bound(symbol));
+}
+
+
+PositionSet::symbol_open_view PositionSet::openView( const std::string& symbol ) const
+{
+  return symbol_open_view(get<symbol_key>().lower_bound(symbol), get<symbol_key>().upper_bound(symbol));
+}
+
+
 PositionSet PositionSet::closed(void) const
 {
+  const closed_view view = closedView();
   PositionSet closedPos;
-
-  for( const_iterator iter = begin(); iter != end(); ++iter )
-    if( (*iter)->closed() )
-      closedPos.insert(*iter);
+  closedPos.insert(view.begin(), view.end());
 
   return closedPos;
 }
@@ -53,14 +63,9 @@ PositionSet PositionSet::closed(void) const
 
 PositionSet PositionSet::closed( const std::string& symbol )
 {
+  const symbol_closed_view view = closedView(symbol);
   PositionSet closedPos;
-
-  PositionSet::by_symbol::const_iterator symbol_key_end = get<symbol_key>().upper_bound(symbol);
-
-  for( PositionSet::by_symbol::const_iterator iter = get<symbol_key>().lower_bound(symbol);
-        iter != symbol_key_end; ++iter )
-    if( (*iter)->closed() )
-      closedPos.insert(*iter);
+  closedPos.insert(view.begin(), view.end());
 
   return closedPos;
 }
@@ -68,11 +73,9 @@ PositionSet PositionSet::closed( const std::string& symbol )
 
 PositionSet PositionSet::open(void) const
 {
+  const open_view view = openView();
   PositionSet openPos;
-
-  for( const_iterator iter = begin(); iter != end(); ++iter )
-    if( (*iter)->open() )
-      openPos.insert(*iter);
+  openPos.insert(view.begin(), view.end());
 
   return openPos;
 }
@@ -80,14 +83,9 @@ PositionSet PositionSet::open(void) const
 
 PositionSet PositionSet::open( const std::string& symbol )
 {
+  const symbol_open_view view = openView(symbol);
   PositionSet openPos;
-
-  PositionSet::by_symbol::const_iterator symbol_key_end = get<symbol_key>().upper_bound(symbol);
-
-  for( PositionSet::by_symbol::const_iterator iter = get<symbol_key>().lower_bound(symbol);
-        iter != symbol_key_end; ++iter )
-    if( (*iter)->open() )
-      openPos.insert(*iter);
+  openPos.insert(view.begin(), view.end());
 
   return openPos;
 }
@@ -95,12 +93,10 @@ PositionSet PositionSet::open( const std::string& symbol )
 
 double PositionSet::realized(void) const
 {
-  PositionSet closedPositions = closed();
-  if( closedPositions.empty() )
-    return 1;
+  const closed_view view = closedView();
 
   double acc = 1;
-  for( const_iterator iter = closedPositions.begin(); iter != closedPositions.end(); ++iter )
+  for( closed_view::const_iterator iter = view.begin(); iter != view.end(); ++iter )
     acc *= (*iter)->factor();
 
   return acc;
@@ -109,12 +105,10 @@ double PositionSet::realized(void) const
 
 double PositionSet::unrealized(void) const
 {
-  PositionSet openPositions = open();
-  if( openPositions.empty() )
-    return 1;
+  const open_view view = openView();
 
   double acc = 1;
-  for( const_iterator iter = openPositions.begin(); iter != openPositions.end(); ++iter )
+  for( open_view::const_iterator iter = view.begin(); iter != view.end(); ++iter )
     acc *= (*iter)->factor();
 
   return acc;
@@ -123,11 +117,9 @@ double PositionSet::unrealized(void) const
 
 PositionSet PositionSet::longPos( void ) const
 {
+  const type_view view = typeView(Position::LONG);
   PositionSet sPos;
-
-  for( const_iterator iter = begin(); iter != end(); ++iter )
-    if( (*iter)->type() == Position::LONG )
-      sPos.insert(*iter);
+  sPos.insert(view.begin(), view.end());
 
   return sPos;
 }
@@ -135,11 +127,9 @@ PositionSet PositionSet::longPos( void ) const
 
 PositionSet PositionSet::shortPos( void ) const
 {
+  const type_view view = typeView(Position::SHORT);
   PositionSet sPos;
-
-  for( const_iterator iter = begin(); iter != end(); ++iter )
-    if( (*iter)->type() == Position::SHORT )
-      sPos.insert(*iter);
+  sPos.insert(view.begin(), view.end());
 
   return sPos;
 }
@@ -147,11 +137,9 @@ PositionSet PositionSet::shortPos( void ) const
 
 PositionSet PositionSet::stratPos( void ) const
 {
+  const type_view view = typeView(Position::STRATEGY);
   PositionSet sPos;
-
-  for( const_iterator iter = begin(); iter != end(); ++iter )
-    if( (*iter)->type() == Position::STRATEGY )
-      sPos.insert(*iter);
+  sPos.insert(view.begin(), view.end());
 
   return sPos;
 }
@@ -159,11 +147,9 @@ PositionSet PositionSet::stratPos( void ) const
 
 PositionSet PositionSet::naturalPos(void) const
 {
+  const natural_view view = naturalView();
   PositionSet sPos;
-
-  for( const_iterator iter = begin(); iter != end(); ++iter )
-    if( (*iter)->type() != Position::STRATEGY )
-      sPos.insert(*iter);
+  sPos.insert(view.begin(), view.end());
 
   return sPos;
 }
@@ -52,6 +52,23 @@ void PositionsReport::print( void ) const
 }
 
 
+void PositionsReport::fill( ReportTable& table, const std::string& prefix ) const
+{
+  if( _pf.num() == 0 )
+    return; // avoid exception in report
+
+  PositionFactorsSet::ExcursionResults ae = _pf.adverse();
+  table.set(prefix + "avg_ae", ae.avg);
+  if( !ae.high.empty() )
+    table.set(prefix + "worst_ae", ae.high.factor() - 1);
+
+  PositionFactorsSet::ExcursionResults fe = _pf.favorable();
+  table.set(prefix + "avg_fe", fe.avg);
+  if( !fe.high.empty() )
+    table.set(prefix + "best_fe", fe.high.factor() - 1);
+}
+
+
 void PositionsReport::favorable(void) const
 {
   if( _pf.num() == 0 )
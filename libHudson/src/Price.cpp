@@ -29,66 +29,106 @@ using namespace std;
 using namespace Series;
 
 
+namespace
+{
+  // Price of type pt in a map record, for series whose columns are not loaded
+  double field( const Series::DayPrice& rec, Series::EODDB::PriceType pt ) throw(PriceException)
+  {
+    switch( pt ) {
+
+      case EODDB::OPEN:
+        return rec.open;
+
+      case EODDB::CLOSE:
+        return rec.close;
+
+      case EODDB::ADJCLOSE:
+        return rec.adjclose;
+
+      default:
+        throw PriceException("Invalid price type");
+    }
+  }
+}
+
+
 Price Price::get( const std::string& symbol, const boost::gregorian::date& dt, Series::EODDB::PriceType pt ) throw(PriceException)
 {
-  // Retrieve price type pt
-  Series::EODSeries::const_iterator citer = Series::EODDB::instance().get(symbol).find(dt);
-  if( citer == Series::EODDB::instance().get(symbol).end() ) {
+  return get(Series::EODDB::instance().get(symbol), dt, pt);
+}
+
+
+Price Price::get( const Series::EODSeries& series, const boost::gregorian::date& dt, Series::EODDB::PriceType pt ) throw(PriceException)
+{
+  if( !series.hasColumns() ) {
+    Series::EODSeries::const_iterator citer = series.find(dt);
+    if( citer == series.end() ) {
+      stringstream ss;
+      ss << "Can't find " << dt << " price record in " << series.name() << " series";
+      throw PriceException(ss.str());
+    }
+
+    return Price(field(citer->second, pt));
+  }
+
+  const size_t row = series.row(dt);
+  if( row == Series::EODSeries::npos ) {
     stringstream ss;
-    ss << "Can't find " << dt << " price record in " << symbol << " series";
+    ss << "Can't find " << dt << " price record in " << series.name() << " series";
     throw PriceException(ss.str());
   }
 
-  double priceval = 0;
-  switch( pt ) {
+  return get(series, row, pt);
+}
 
-    case EODDB::OPEN:
-      priceval = citer->second.open;
-      break;
 
-    case EODDB::CLOSE:
-      priceval = citer->second.close;
-      break;
+Price Price::get( const Series::EODSeries& series, size_t row, Series::EODDB::PriceType pt ) throw(PriceException)
+{
+  const vector<double>& prices = column(series, pt);
+  if( row >= prices.size() )
+    throw PriceException("Row out of range");
 
-    case EODDB::ADJCLOSE:
-      priceval = citer->second.adjclose;
-      break;
+  return Price(prices[row]);
+}
 
-    default:
-      throw PriceException("Invalid price type");
-  }
 
-  return Price(priceval);
+Price Price::last( const std::string& symbol, Series::EODDB::PriceType pt ) throw(PriceException)
+{
+  return last(Series::EODDB::instance().get(symbol), pt);
 }
 
 
-Price Price::last( const std::string& symbol, Series::EODDB::PriceType pt ) throw(PriceException)
+Price Price::last( const Series::EODSeries& series, Series::EODDB::PriceType pt ) throw(PriceException)
 {
-  if( Series::EODDB::instance().get(symbol).empty() )
+  if( series.empty() )
     throw PriceException("Empty series database");
 
-  Series::DayPrice item = Series::EODDB::instance().get(symbol).last();
+  if( !series.hasColumns() )
+    return Price(field(series.last(), pt));
+
+  return get(series, series.size() - 1, pt);
+}
+
 
-  double priceval = 0;
-  switch ( pt ) {
+const vector<double>& Price::column( const Series::EODSeries& series, Series::EODDB::PriceType pt ) throw(PriceException)
+{
+  if( !series.hasColumns() )
+    throw PriceException("Series price columns are not loaded");
+
+  switch( pt ) {
 
     case EODDB::OPEN:
-      priceval = item.open;
-      break;
+      return series.openColumn();
 
     case EODDB::CLOSE:
-      priceval = item.close;
-      break;
+      return series.closeColumn();
 
     case EODDB::ADJCLOSE:
-      priceval = item.adjclose;
-      break;
+      return series.adjcloseColumn();
 
     default:
       throw PriceException("Invalid price type");
   }
-
-  return Price(priceval);
 }
 
 
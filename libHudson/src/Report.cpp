@@ -92,6 +92,31 @@ void Report::print(void) const
 }
 
 
+void Report::fill(ReportTable& table, const std::string& prefix) const
+{
+  table.set(prefix + "trades", _rf.num());
+  table.set(prefix + "avg_trade", _rf.avg());
+  table.set(prefix + "std_dev", _rf.stddev());
+  table.set(prefix + "skew", _rf.skew());
+  table.set(prefix + "pos_trades", _rf_pos.num());
+  table.set(prefix + "neg_trades", _rf_neg.num());
+  table.set(prefix + "avg_pos", _rf_pos.avg());
+  table.set(prefix + "avg_neg", _rf_neg.avg());
+  table.set(prefix + "roi", _rf.roi());
+
+  if( _rf.num() == 0 )
+    return; // leave position statistics missing
+
+  table.set(prefix + "best", _rf.best().factor() - 1);
+  table.set(prefix + "worst", _rf.worst().factor() - 1);
+  table.set(prefix + "max_cons_pos", _rf.max_cons_pos().size());
+  table.set(prefix + "max_cons_neg", _rf.max_cons_neg().size());
+
+  PositionSet pset = _rf.dd();
+  table.set(prefix + "max_dd", pset.empty() ? 0 : ReturnFactors(pset).roi());
+}
+
+
 void Report::best(void) const
 {
   if( _rf.num() == 0 )
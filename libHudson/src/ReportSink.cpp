@@ -0,0 +1,276 @@
+/*
+* Copyright (C) 2007,2008, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StdAfx.hpp"
+
+// C
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// STL
+#include <iostream>
+
+// Hudson
+#include "ReportSink.hpp"
+
+using namespace std;
+
+
+namespace {
+
+  void append_number(string& out, double value)
+  {
+    // Shortest of 15 or 17 digits that reads back the same value
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "%.15g", value);
+    if( strtod(buf, 0) != value )
+      n = snprintf(buf, sizeof(buf), "%.17g", value);
+    out.append(buf, n);
+  }
+
+  void append_csv(string& out, const string& text)
+  {
+    if( text.find_first_of(",\"\r\n") == string::npos ) {
+      out += text;
+      return;
+    }
+
+    out += '"';
+    for( string::const_iterator it = text.begin(); it != text.end(); ++it ) {
+      if( *it == '"' ) out += '"';
+      out += *it;
+    }
+    out += '"';
+  }
+
+  void append_json(string& out, const string& text)
+  {
+    out += '"';
+    for( string::const_iterator it = text.begin(); it != text.end(); ++it ) {
+      switch( *it ) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+          if( (unsigned char)*it < 0x20 ) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)(unsigned char)*it);
+            out += buf;
+          } else {
+            out += *it;
+          }
+      }
+    }
+    out += '"';
+  }
+
+  template <typename T>
+  void append_raw(string& out, T value)
+  {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void append_raw_str(string& out, const string& text)
+  {
+    append_raw<uint32_t>(out, (uint32_t)text.size());
+    out += text;
+  }
+
+} // namespace
+
+
+ReportSink::ReportSink(const std::string& path, bool binary) throw(ReportSinkException):
+  _os(&cout)
+{
+  if( path == "-" )
+    return;
+
+  _file.open(path.c_str(), binary ? ios::out | ios::trunc | ios::binary : ios::out | ios::trunc);
+  if( !_file )
+    throw ReportSinkException(string("Can't open ") + path);
+
+  _os = &_file;
+}
+
+
+ReportSink::~ReportSink(void)
+{
+  _os->flush();
+}
+
+
+void ReportSink::write(const ReportTable& table) throw(ReportSinkException)
+{
+  // Format outside the lock, concurrent writers only wait for the copy
+  string out;
+  _format(table, out);
+  const string header = _header(table);
+
+  lock_guard<mutex> lock(_mutex);
+
+  if( !header.empty() ) {
+    if( _written_header.empty() ) {
+      _os->write(header.data(), header.size());
+      _written_header = header;
+    } else if( header != _written_header ) {
+      throw ReportSinkException("Table columns differ from the header already written");
+    }
+  }
+
+  _os->write(out.data(), out.size());
+  if( !*_os )
+    throw ReportSinkException("Write failed");
+}
+
+
+void ReportSink::flush(void)
+{
+  lock_guard<mutex> lock(_mutex);
+  _os->flush();
+}
+
+
+ReportSinkPtr ReportSink::create(Format fmt, const std::string& path) throw(ReportSinkException)
+{
+  switch( fmt ) {
+    case CSV:    return ReportSinkPtr(new CSVReportSink(path));
+    case JSONL:  return ReportSinkPtr(new JSONLReportSink(path));
+    case BINARY: return ReportSinkPtr(new BinaryReportSink(path));
+  }
+
+  throw ReportSinkException("Unknown format");
+}
+
+
+std::string ReportSink::format_str(Format fmt)
+{
+  switch( fmt ) {
+    case CSV:    return "csv";
+    case JSONL:  return "jsonl";
+    case BINARY: return "binary";
+  }
+
+  return "unknown";
+}
+
+
+ReportSink::Format ReportSink::format_from_str(const std::string& name) throw(ReportSinkException)
+{
+  if( name == "csv" ) return CSV;
+  if( name == "jsonl" ) return JSONL;
+  if( name == "binary" ) return BINARY;
+
+  throw ReportSinkException(string("Unknown format ") + name);
+}
+
+
+std::string CSVReportSink::_header(const ReportTable& table) const
+{
+  string out;
+  for( size_t col = 0; col < table.columns(); ++col ) {
+    if( col ) out += ',';
+    append_csv(out, table.column_name(col));
+  }
+  out += '\n';
+
+  return out;
+}
+
+
+void CSVReportSink::_format(const ReportTable& table, std::string& out) const
+{
+  out.reserve(out.size() + table.rows() * table.columns() * 12);
+
+  for( size_t row = 0; row < table.rows(); ++row ) {
+    for( size_t col = 0; col < table.columns(); ++col ) {
+      if( col ) out += ',';
+      if( table.column_type(col) == ReportTable::TEXT ) {
+        append_csv(out, table.texts(col)[row]);
+      } else {
+        const double value = table.numbers(col)[row];
+        if( !std::isnan(value) ) append_number(out, value);
+      }
+    }
+    out += '\n';
+  }
+}
+
+
+void JSONLReportSink::_format(const ReportTable& table, std::string& out) const
+{
+  // Keys are the same on every row
+  vector<string> vKeys(table.columns());
+  for( size_t col = 0; col < table.columns(); ++col ) {
+    append_json(vKeys[col], table.column_name(col));
+    vKeys[col] += ':';
+  }
+
+  string prefix("{");
+  if( !table.name().empty() ) {
+    prefix += "\"table\":";
+    append_json(prefix, table.name());
+    if( table.columns() ) prefix += ',';
+  }
+
+  out.reserve(out.size() + table.rows() * table.columns() * 24);
+
+  for( size_t row = 0; row < table.rows(); ++row ) {
+    out += prefix;
+    for( size_t col = 0; col < table.columns(); ++col ) {
+      if( col ) out += ',';
+      out += vKeys[col];
+      if( table.column_type(col) == ReportTable::TEXT ) {
+        append_json(out, table.texts(col)[row]);
+      } else {
+        const double value = table.numbers(col)[row];
+        if( std::isfinite(value) ) append_number(out, value);
+        else out += "null";
+      }
+    }
+    out += "}\n";
+  }
+}
+
+
+void BinaryReportSink::_format(const ReportTable& table, std::string& out) const
+{
+  out += "HRT1";
+  append_raw_str(out, table.name());
+  append_raw<uint32_t>(out, (uint32_t)table.columns());
+  append_raw<uint64_t>(out, (uint64_t)table.rows());
+
+  for( size_t col = 0; col < table.columns(); ++col ) {
+    append_raw<uint8_t>(out, table.column_type(col) == ReportTable::TEXT ? 1 : 0);
+    append_raw_str(out, table.column_name(col));
+
+    if( table.column_type(col) == ReportTable::TEXT ) {
+      const vector<string>& vTexts = table.texts(col);
+      for( vector<string>::const_iterator it = vTexts.begin(); it != vTexts.end(); ++it )
+        append_raw_str(out, *it);
+    } else {
+      const vector<double>& vNumbers = table.numbers(col);
+      if( !vNumbers.empty() )
+        out.append(reinterpret_cast<const char*>(&vNumbers[0]), vNumbers.size() * sizeof(double));
+    }
+  }
+}
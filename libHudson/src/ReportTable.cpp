@@ -0,0 +1,167 @@
+/*
+* Copyright (C) 2007,2008, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StdAfx.hpp"
+
+// STL
+#include <algorithm>
+#include <limits>
+
+// Hudson
+#include "ReportTable.hpp"
+
+using namespace std;
+
+
+ReportTable::ReportTable(const std::string& name):
+  _name(name),
+  _rows(0)
+{
+}
+
+
+std::size_t ReportTable::find(const std::string& name) const
+{
+  for( size_t i = 0; i < _vColumns.size(); ++i )
+    if( _vColumns[i].name == name )
+      return i;
+
+  return _vColumns.size();
+}
+
+
+std::size_t ReportTable::column(const std::string& name, ColumnType type) throw(ReportTableException)
+{
+  size_t col = find(name);
+  if( col < _vColumns.size() ) {
+    if( _vColumns[col].type != type )
+      throw ReportTableException(string("Column ") + name + " has a different type");
+    return col;
+  }
+
+  Column c;
+  c.name = name;
+  c.type = type;
+  if( type == NUMBER )
+    c.numbers.assign(_rows, numeric_limits<double>::quiet_NaN());
+  else
+    c.texts.assign(_rows, string());
+
+  _vColumns.push_back(c);
+  return col;
+}
+
+
+std::size_t ReportTable::add_row(void)
+{
+  for( vector<Column>::iterator it = _vColumns.begin(); it != _vColumns.end(); ++it ) {
+    if( it->type == NUMBER )
+      it->numbers.push_back(numeric_limits<double>::quiet_NaN());
+    else
+      it->texts.push_back(string());
+  }
+
+  return _rows++;
+}
+
+
+ReportTable::Column& ReportTable::_at(std::size_t col, std::size_t row, ColumnType type) throw(ReportTableException)
+{
+  if( col >= _vColumns.size() || row >= _rows )
+    throw ReportTableException("Cell out of range");
+
+  if( _vColumns[col].type != type )
+    throw ReportTableException(string("Column ") + _vColumns[col].name + " has a different type");
+
+  return _vColumns[col];
+}
+
+
+void ReportTable::set(const std::string& name, double value) throw(ReportTableException)
+{
+  if( _rows == 0 )
+    throw ReportTableException("No rows");
+
+  set(column(name, NUMBER), _rows - 1, value);
+}
+
+
+void ReportTable::set(const std::string& name, const std::string& value) throw(ReportTableException)
+{
+  if( _rows == 0 )
+    throw ReportTableException("No rows");
+
+  set(column(name, TEXT), _rows - 1, value);
+}
+
+
+void ReportTable::set(std::size_t col, std::size_t row, double value) throw(ReportTableException)
+{
+  _at(col, row, NUMBER).numbers[row] = value;
+}
+
+
+void ReportTable::set(std::size_t col, std::size_t row, const std::string& value) throw(ReportTableException)
+{
+  _at(col, row, TEXT).texts[row] = value;
+}
+
+
+void ReportTable::append(const ReportTable& table) throw(ReportTableException)
+{
+  if( &table == this ) {
+    const ReportTable self(table);
+    append(self);
+    return;
+  }
+
+  // Add the missing columns first, every column then grows by the same number of rows
+  vector<size_t> vCols(table.columns());
+  for( size_t i = 0; i < table.columns(); ++i )
+    vCols[i] = column(table.column_name(i), table.column_type(i));
+
+  const size_t first = _rows;
+  _rows += table.rows();
+
+  for( vector<Column>::iterator it = _vColumns.begin(); it != _vColumns.end(); ++it ) {
+    if( it->type == NUMBER )
+      it->numbers.resize(_rows, numeric_limits<double>::quiet_NaN());
+    else
+      it->texts.resize(_rows, string());
+  }
+
+  for( size_t i = 0; i < table.columns(); ++i ) {
+    Column& c = _vColumns[vCols[i]];
+    if( c.type == NUMBER )
+      copy(table.numbers(i).begin(), table.numbers(i).end(), c.numbers.begin() + first);
+    else
+      copy(table.texts(i).begin(), table.texts(i).end(), c.texts.begin() + first);
+  }
+}
+
+
+void ReportTable::clear(void)
+{
+  for( vector<Column>::iterator it = _vColumns.begin(); it != _vColumns.end(); ++it ) {
+    it->numbers.clear();
+    it->texts.clear();
+  }
+
+  _rows = 0;
+}
@@ -26,18 +26,11 @@
 #include <numeric>
 #include <algorithm>
 
-// Boost
-#include <boost/lambda/lambda.hpp>
-
-// GSL
-#include <gsl/gsl_statistics_double.h>
-
 // Hudson
 #include "ReturnFactors.hpp"
 #include "PositionFactors.hpp"
 
 using namespace std;
-namespace lmb = boost::lambda;
 
 
 ReturnFactors::ReturnFactors(const PositionSet& sPositions):
@@ -49,13 +42,16 @@ ReturnFactors::ReturnFactors(const PositionSet& sPositions):
   if( _sPositions.empty() )
     return;
 
-  // Initialize time-ordered position factors by last execution (position close)
-  for( PositionSet::by_last_exec::iterator iter = _sPositions.get<last_exec_key>().begin(); iter != _sPositions.get<last_exec_key>().end(); ++iter )
+  // Initialize time-ordered position factors by last execution (position close), statistics in the same pass
+  _vFactors.reserve(_sPositions.size());
+  for( PositionSet::by_last_exec::iterator iter = _sPositions.get<last_exec_key>().begin(); iter != _sPositions.get<last_exec_key>().end(); ++iter ) {
     _vFactors.push_back( (*iter)->factor() );
+    _stats.add(_vFactors.back());
+  }
 
-  _fvalue = accumulate<doubleVector::const_iterator, double>( _vFactors.begin(), _vFactors.end(), 1, lmb::_1 * lmb::_2 );
-  _mean = accumulate<doubleVector::const_iterator, double>( _vFactors.begin(), _vFactors.end(), 0 ) / _vFactors.size();
-  _stddev = ::sqrt( accumulate<doubleVector::const_iterator, double>( _vFactors.begin(), _vFactors.end(), 0, variance_bf(_mean) ) / (_vFactors.size() - 1) );
+  _fvalue = _stats.roi() + 1;
+  _mean = _stats.avg() + 1;
+  _stddev = _stats.stddev();
 }
 
 
@@ -79,11 +75,7 @@ double ReturnFactors::stddev(void) const
 
 double ReturnFactors::skew(void) const
 {
-  if( _vFactors.size() < 2 ) return 0;
-
-  //  return ( accumulate<vdouble::const_iterator, double>( _vf.begin(), _vf.end(), 0, skew1(_mean) ) ) /
-  //((_vf.size() - 1) * pow(_stddev, 3));
-  return gsl_stats_skew_m_sd(&_vFactors[0], 1, _vFactors.size(), _mean, _stddev);
+  return _stats.skew();
 }
 
 
@@ -206,34 +198,46 @@ PositionSet ReturnFactors::dd(void) const throw(ReturnFactorsException)
   if( _sPositions.empty() )
     throw ReturnFactorsException("Empty positions set");
 
-  vector<PositionSet> dd; // all drawdowns
-  // calculate drawdown from each position
-  for( PositionSet::by_last_exec::iterator iter = _sPositions.get<last_exec_key>().begin(); iter != _sPositions.get<last_exec_key>().end(); ++iter )
-    dd.push_back(_dd(iter)); // add drawdown from this point
+  doubleVector::size_type first = 0, last = 0;
+  if( !_dd(first, last) )
+    return PositionSet(); // No losing sequence
 
-  if( dd.empty() )
-    return PositionSet(); // min_element() crashes on empty vector
+  // Build the result only for the highest drawdown rows
+  PositionSet dd_pset;
+  PositionSet::by_last_exec::iterator iter = _sPositions.get<last_exec_key>().begin();
+  advance(iter, first);
+  for( doubleVector::size_type i = first; i <= last; ++i, ++iter )
+    dd_pset.insert(*iter);
 
-  // return highest drawdown
-  return *min_element(dd.begin(), dd.end(), PositionSetRealizedCmp());
+  return dd_pset;
 }
 
 
-PositionSet ReturnFactors::_dd(PositionSet::by_last_exec::iterator& start) const
+bool ReturnFactors::_dd(doubleVector::size_type& first, doubleVector::size_type& last) const
 {
-  PositionSet pset, dd_pset;
-  double acc = 1;
-  double my_dd = 1;
+  // Single pass over the cumulative factor: the drawdown ending at position j is the compounded
+  // value after j divided by the highest compounded value seen before any position up to j.
+  double acc = 1;         // compounded factor before position j
+  double peak = 1;        // highest compounded factor so far
+  double my_dd = 1;       // lowest drawdown found
+  doubleVector::size_type peak_row = 0;
+  bool found = false;
+
+  for( doubleVector::size_type j = 0; j < _vFactors.size(); ++j ) {
+    if( acc > peak ) {
+      peak = acc;
+      peak_row = j;
+    }
 
-  for( PositionSet::by_last_exec::iterator iter = start; iter != _sPositions.get<last_exec_key>().end(); ++iter ) {
-    pset.insert(*iter);
-    acc *= (*iter)->factor();
+    acc *= _vFactors[j];
 
-    if( acc < my_dd ) {
-      my_dd = acc;
-      dd_pset = pset;
+    if( acc / peak < my_dd ) {
+      my_dd = acc / peak;
+      first = peak_row;
+      last = j;
+      found = true;
     }
   }
 
-  return dd_pset;
+  return found;
 }
@@ -129,7 +129,7 @@ double ShortPosition::factor( EODDB::PriceType pt ) const throw(PositionExceptio
   if( !isValid() )
     throw PositionException("Invalid position state");
 
-  return closed() ? (_avgShortPrice / _avgCoverPrice) : (_avgShortPrice / Price::last(_symbol, pt).value());
+  return closed() ? (_avgShortPrice / _avgCoverPrice) : (_avgShortPrice / Price::last(series(), pt).value());
 }
 
 
@@ -141,7 +141,7 @@ double ShortPosition::factor( const boost::gregorian::date& dt, EODDB::PriceType
   if( dt <= first_exec()->dt() )
     throw PositionException("Requested date after first execution date");
 
-  return _avgShortPrice / Price::get(_symbol, dt, pt).value();
+  return _avgShortPrice / Price::get(series(), dt, pt).value();
 }
 
 
@@ -151,7 +151,7 @@ double ShortPosition::factor( const boost::gregorian::date_period& dp, EODDB::Pr
   if( ! hold_period().contains(dp) )
     throw PositionException("Requested factor period is out of Position range");
 
-  return Price::get(_symbol, dp.begin(), pt) / Price::get(_symbol, dp.end(), pt);
+  return Price::get(series(), dp.begin(), pt) / Price::get(series(), dp.end(), pt);
 }
 
 
@@ -167,18 +167,11 @@ double ShortPosition::factor( const boost::gregorian::date::month_type& month, c
   if( first_exec()->dt() > end_mark || (closed() && last_exec()->dt() < begin_mark) )
     throw PositionException("Position executions are not included in given range");
 
-  // Get symbol series
-  const Series::EODSeries& db = Series::EODDB::instance().get(_symbol);
-
   // Extract begin of period price
   double begin_price = 0;
   // If position was opened before begin mark, then use begin_mark price (previous month last close)
   if( first_exec()->dt() <= begin_mark ) {
-    EODSeries::const_iterator citer = db.at_or_before(begin_mark);
-    if( citer == db.end() )
-      throw PositionException("Can't get begin-period price");
-
-    begin_price = Price::get(_symbol, citer->first, pt).value();
+    begin_price = mark_price(begin_mark, pt);
 #ifdef DEBUG
     //cout << "Position opened before or at previous EOM mark price, using " << citer->first << " adjclose" << endl;
 #endif
@@ -199,11 +192,7 @@ double ShortPosition::factor( const boost::gregorian::date::month_type& month, c
   double end_price = 0;
   // If position is open or was closed after end-month mark, use end-month price
   if( open() || last_exec()->dt() > end_mark ) {
-    EODSeries::const_iterator citer = db.at_or_before(end_mark);
-    if( citer == db.end() )
-      throw PositionException("Can't get end-period price");
-
-    end_price = Price::get(_symbol, citer->first, pt).value();
+    end_price = mark_price(end_mark, pt);
 #ifdef DEBUG
     //cout << "Position still open or closed after EOM mark price, using " << em_mark->first << " adjclose" << endl;
 #endif
@@ -229,11 +218,11 @@ SeriesFactorSet ShortPosition::factors(Series::EODDB::PriceType pt) const throw(
 {
 #ifdef DEBUG
   cout << "Short Position " << _id << " first exec " << first_exec()->dt() << ", last exec " << last_exec()->dt() << endl;
-  cout << "Symbol " << _symbol << " end of database: " << EODDB::instance().get(_symbol).rbegin()->first << endl;
+  cout << "Symbol " << _symbol << " end of database: " << series().rbegin()->first << endl;
   cout << "Is Position closed: " << closed() << endl;
 #endif
 
-  date last_dt = (closed() ? last_exec()->dt() : EODDB::instance().get(_symbol).rbegin()->first);
+  date last_dt = (closed() ? last_exec()->dt() : series().rbegin()->first);
 
   date_period dp(first_exec()->dt(), last_dt);
   return factors(dp, pt);
@@ -249,39 +238,6 @@ SeriesFactorSet ShortPosition::factors( const boost::gregorian::date& dt, Series
 
 SeriesFactorSet ShortPosition::factors( const boost::gregorian::date_period& dp, EODDB::PriceType pt /*= EODDB::PriceType::ADJCLOSE*/ ) const throw(PositionException)
 {
-  SeriesFactorSet sfs(_id);
-
-#ifdef DEBUG
-  cout << "Extracting daily factors for short position " << _id << " (" << _symbol << ") from " << dp.begin() << " to " << dp.last() << endl;
-#endif
-
-  if( ! hold_period().contains(dp) )
-    throw PositionException("Requested period is out of range");
-
-  const EODSeries& series = EODDB::instance().get(_symbol);
-
-  EODSeries::const_iterator citer = series.after(dp.begin(), 0);
-  if( citer == series.end() )
-    throw PositionException("Can't find begin of period in series");
-
-  date prev_date = citer->first;
-
-  for( EODSeries::const_iterator citer = series.after(dp.begin()); citer != series.end(); ++citer ) {
-
-    // If we're over the end of requested period or if the position is closed and we're over the last execution date, then we're done
-    if( (*citer).first > dp.last() || (closed() && (*citer).first > last_exec()->dt()) )
-      break;
-
-    double f = factor(date_period(prev_date, citer->first), pt);
-    sfs.insert(SeriesFactor(prev_date, citer->first, f));
-
-#ifdef DEBUG
-    cout << "Previous date: " << prev_date << ", current date: " << citer->first << ", factor: " << f << endl;
-#endif
-
-    prev_date = citer->first;
-  }
-
-  return sfs;
+  return daily_factors(dp, pt, true);
 }
 
@@ -22,9 +22,15 @@
 // STDLIB
 #include <iostream>
 
+// STL
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 // Hudson
 #include "StrategyPosition.hpp"
 #include "SeriesFactorSet.hpp"
+#include "PositionFactorCache.hpp"
 
 using namespace std;
 using namespace boost::gregorian;
@@ -46,6 +52,9 @@ void StrategyPosition::update(const ExecutionPtr pExe)
 
   if( _sExecutions.insert(pExe).second == false )
     throw PositionException("Can not insert execution in StrategyPosition set");
+
+  // Daily factors changed with the new leg execution
+  PositionFactorCache::instance().invalidate(_id);
 }
 
 
@@ -70,6 +79,8 @@ void StrategyPosition::add( const PositionPtr pPos, double weight ) throw(Positi
 
   // Listen Position executions
   pPos->attach(this);
+
+  PositionFactorCache::instance().invalidate(_id);
 }
 
 
@@ -204,7 +215,7 @@ SeriesFactorSet StrategyPosition::factors(Series::EODDB::PriceType pt) const thr
   cout << "Strategy Position " << _id << " first exec " << first_exec()->dt() << ", last exec " << last_exec()->dt() << endl;
   cout << "Number of legs: " << _mPositions.size() << endl;
 #endif
-  date last_dt = (closed() ? last_exec()->dt() : EODDB::instance().get(_symbol).rbegin()->first);
+  date last_dt = (closed() ? last_exec()->dt() : series().rbegin()->first);
 
   date_period dp(first_exec()->dt(), last_dt);
   return factors(dp, pt);
@@ -220,65 +231,44 @@ SeriesFactorSet StrategyPosition::factors( const boost::gregorian::date& dt, Ser
 
 SeriesFactorSet StrategyPosition::factors( const boost::gregorian::date_period& dp, EODDB::PriceType pt ) const throw(PositionException)
 {
-  // Accumulate all factors with the same begin/end date for all underlying positions
-  SeriesFactorMultiSetFrom sfsAll;
-
-  // Add all SeriesFactor for all underlying positions indexed by first execution date
+  // Daily factors of each leg as rows ordered by from/to date
+  vector<SF_ROWS> vLegs;
+  vLegs.reserve(_mPositions.size());
   for( POSW_MAP::const_iterator citer = _mPositions.begin(); citer != _mPositions.end(); ++citer ) {
     SeriesFactorSet sfs = (*citer).second.pPos->factors(dp, pt);
-    for( SeriesFactorSet::const_iterator sfs_citer = sfs.begin(); sfs_citer != sfs.end(); ++sfs_citer ) {
-#ifdef DEBUG
-      cout << "Inserting position " << (*citer).second.pPos->id() << " factor from " << (*sfs_citer).from_tm() << ", to " << (*sfs_citer).to_tm() << endl;
-#endif
-      sfsAll.insert(*sfs_citer);
-    }
-  }
-
-#ifdef DEBUG
-  cout << "Printing all factors..." << endl;
-  for( SeriesFactorMultiSetFrom::const_iterator citer = sfsAll.begin(); citer != sfsAll.end(); ++citer )
-    cout << "Factor " << (*citer).factor() << " from " << (*citer).from_tm() << " to " << (*citer).to_tm() << endl;
-#endif
-
-  return _matchFactors(sfsAll);
-}
-
+    const SeriesFactorSet::by_from& sfsByFrom = sfs.get<from_key>();
 
-SeriesFactorSet StrategyPosition::_matchFactors(const SeriesFactorMultiSetFrom& sfsAll) const
-{
-  SeriesFactorSet sfsStrategy(_id);
-
-  // Extract current factor
-  for( SeriesFactorMultiSetFrom::const_iterator citer = sfsAll.begin(); citer != sfsAll.end(); ) {
-
-    double acc = 1;
-    // Get current factor
-    SeriesFactor currentFactor = *citer;
-    acc += (currentFactor.factor() - 1);
-
-#ifdef DEBUG
+    vLegs.push_back(SF_ROWS(sfsByFrom.begin(), sfsByFrom.end()));
+    if( !is_sorted(vLegs.back().begin(), vLegs.back().end(), SeriesFactorPeriodCmp()) )
+      stable_sort(vLegs.back().begin(), vLegs.back().end(), SeriesFactorPeriodCmp());
+  }
 
-    cout << "Analyzing Position daily factor from " << currentFactor.from_tm() << " to " << currentFactor.to_tm()
-	 << " factor " << currentFactor.factor() << endl;
-#endif
+  // Shared calendar: union of all leg from/to periods, one linear merge per leg
+  SF_ROWS vCalendar, vMerged;
+  for( vector<SF_ROWS>::const_iterator liter = vLegs.begin(); liter != vLegs.end(); ++liter ) {
+    vMerged.clear();
+    vMerged.reserve(vCalendar.size() + liter->size());
+    set_union(vCalendar.begin(), vCalendar.end(), liter->begin(), liter->end(), back_inserter(vMerged), SeriesFactorPeriodCmp());
+    vCalendar.swap(vMerged);
+  }
 
-    // Accumulate all the following factors with the same from/to date
-    SeriesFactorMultiSetFrom::const_iterator citer_next = citer;
-    while( ++citer_next != sfsAll.end() && citer_next->from_tm() == currentFactor.from_tm() && citer_next->to_tm() == currentFactor.to_tm() ) {
-#ifdef DEBUG
-      cout << "Found daily factor with same from/to dates, factor " << citer_next->factor() << endl;
-#endif
-      acc += (citer_next->factor() - 1);
+  // Add each leg factor into its calendar row, walking leg rows and calendar rows together
+  vector<double> vAcc(vCalendar.size(), 1);
+  for( vector<SF_ROWS>::const_iterator liter = vLegs.begin(); liter != vLegs.end(); ++liter ) {
+    SF_ROWS::size_type row = 0;
+    for( SF_ROWS::const_iterator citer = liter->begin(); citer != liter->end(); ++citer ) {
+      while( SeriesFactorPeriodCmp()(vCalendar[row], *citer) )
+        ++row;
+      vAcc[row] += ((*citer).factor() - 1);
     }
+  }
 
-    // Add cumulated factor
+  SeriesFactorSet sfsStrategy(_id);
+  for( SF_ROWS::size_type row = 0; row < vCalendar.size(); ++row ) {
 #ifdef DEBUG
-    cout << "Adding acc factor " << acc << " from " << currentFactor.from_tm() << " to " << currentFactor.to_tm() << endl;
+    cout << "Adding acc factor " << vAcc[row] << " from " << vCalendar[row].from_tm() << " to " << vCalendar[row].to_tm() << endl;
 #endif
-    sfsStrategy.insert(SeriesFactor(currentFactor.from_tm(), currentFactor.to_tm(), acc));
-
-    // Start from first SeriesFactor with different from/to date
-    citer = citer_next;
+    sfsStrategy.insert(SeriesFactor(vCalendar[row].from_tm(), vCalendar[row].to_tm(), vAcc[row]));
   }
 
   return sfsStrategy;
@@ -34,10 +34,11 @@ using namespace Series;
 Position::ID StrategyTrader::strategy( const std::string& symbol, PositionPtr pPos, double weight ) throw(TraderException)
 {
   PositionPtr pStratPos; // The new StrategyPosition
+  const Position::ID id = ++_pid;
 
   try {
 
-    pStratPos = PositionPtr(new StrategyPosition(++_pid, symbol, pPos, weight));
+    pStratPos = PositionPtr(new StrategyPosition(id, symbol, pPos, weight));
 
   } catch (const std::exception& ex) {
 
@@ -48,8 +49,10 @@ Position::ID StrategyTrader::strategy( const std::string& symbol, PositionPtr pP
   if( _miPositions.insert(pStratPos).first == _miPositions.end() )
     throw TraderException("Can't add new strategy position");
 
+  _indexOpen(pStratPos);
+
   // Return new position ID
-  return _pid; 
+  return id; 
 }
 
 
@@ -135,8 +138,16 @@ void StrategyTrader::strategy_close( Position::ID strat_id, const boost::gregori
   if( iter == _miPositions.end() )
     throw TraderException("Can't find position");
 
-  // Close position
+  // Close position, remembering the legs closed by it for stats()
   PositionPtr pPos = *iter;
+  vector<PositionPtr> vClosing;
+  StrategyPositionPtr pStratPos = dynamic_pointer_cast<StrategyPosition>(pPos);
+  if( pStratPos ) {
+    for( StrategyPosition::POSW_MAP::const_iterator citer = pStratPos->legs().begin(); citer != pStratPos->legs().end(); ++citer )
+      if( (*citer).second.pPos->open() )
+        vClosing.push_back((*citer).second.pPos);
+  }
+
   try {
 
     pPos->close(dt, pt);
@@ -146,6 +157,10 @@ void StrategyTrader::strategy_close( Position::ID strat_id, const boost::gregori
     throw TraderException(ex.what());
   }
 
+  for( vector<PositionPtr>::const_iterator citer = vClosing.begin(); citer != vClosing.end(); ++citer )
+    _closed(*citer);
+  _closed(pPos);
+
   // Update existing position
   if( _miPositions.replace(iter, pPos) == false )
     throw TraderException("Can't update position");
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2007,2008 Alberto Giannetti
+ *
+ * This file is part of Hudson.
+ *
+ * Hudson is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Hudson is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StdAfx.hpp"
+
+// STL
+#include <algorithm>
+#include <sstream>
+
+// Hudson
+#include "TradeLedger.hpp"
+#include "LongPosition.hpp"
+#include "ShortPosition.hpp"
+
+using namespace std;
+using namespace boost::gregorian;
+
+
+namespace {
+
+  struct ledger_pos_id_lt
+  {
+    template <class P>
+    bool operator()(const P& p, Position::ID id) const { return p.id < id; }
+  };
+
+}
+
+
+TradeLedger::TradeLedger(void):
+  _replayed(0)
+{
+}
+
+
+void TradeLedger::open(Position::ID id, Position::Type type, const string& symbol, const date& dt, const Price& price, unsigned size) throw(TradeLedgerException)
+{
+  if( type != Position::LONG && type != Position::SHORT )
+    throw TradeLedgerException("Only long and short positions can be recorded");
+
+  if( !_vPositions.empty() && id <= _vPositions.back().id )
+    throw TradeLedgerException("Position ids must be increasing");
+
+  if( size == 0 )
+    throw TradeLedgerException("Invalid size");
+
+  if( dt.is_not_a_date() )
+    throw TradeLedgerException("Invalid date");
+
+  if( !price.isValid() )
+    throw TradeLedgerException("Invalid price");
+
+  LedgerPosition pos;
+  pos.id = id;
+  pos.symbol = _intern(symbol);
+  pos.type = type;
+  pos.size = size;
+  pos.entryValue = price.value() * size;
+  pos.entrySize = size;
+  pos.exitValue = 0;
+  pos.exitSize = 0;
+  _vPositions.push_back(pos);
+
+  LedgerExecution exe = { _vPositions.size() - 1, type == Position::LONG ? Execution::BUY : Execution::SHORT, dt, price, size };
+  _vExecutions.push_back(exe);
+
+  _setOpen(pos, _vPositions.size() - 1, true);
+}
+
+
+void TradeLedger::execute(Position::ID id, Execution::Side side, const date& dt, const Price& price, unsigned size) throw(TradeLedgerException)
+{
+  const size_t index = _find(id);
+  LedgerPosition& pos = _vPositions[index];
+
+  if( pos.size == 0 )
+    throw TradeLedgerException("Position is closed");
+
+  if( pos.type == Position::LONG && ( side == Execution::SHORT || side == Execution::COVER ) )
+    throw TradeLedgerException("Can't sell short or cover long position");
+
+  if( pos.type == Position::SHORT && ( side == Execution::BUY || side == Execution::SELL ) )
+    throw TradeLedgerException("Can't buy or sell short position");
+
+  const bool reduce = ( side == Execution::SELL || side == Execution::COVER );
+  if( size == 0 || ( reduce && size > pos.size ) )
+    throw TradeLedgerException("Invalid size");
+
+  if( dt.is_not_a_date() )
+    throw TradeLedgerException("Invalid date");
+
+  if( !price.isValid() )
+    throw TradeLedgerException("Invalid price");
+
+  LedgerExecution exe = { index, side, dt, price, size };
+  _vExecutions.push_back(exe);
+
+  if( reduce ) {
+    pos.exitValue += price.value() * size;
+    pos.exitSize += size;
+  } else {
+    pos.entryValue += price.value() * size;
+    pos.entrySize += size;
+  }
+
+  pos.size = reduce ? pos.size - size : pos.size + size;
+  if( pos.size == 0 )
+    _setOpen(pos, index, false);
+}
+
+
+void TradeLedger::close(Position::ID id, const date& dt, const Price& price) throw(TradeLedgerException)
+{
+  const LedgerPosition& pos = _vPositions[_find(id)];
+  execute(id, pos.type == Position::LONG ? Execution::SELL : Execution::COVER, dt, price, pos.size);
+}
+
+
+bool TradeLedger::has(Position::ID id) const
+{
+  vector<LedgerPosition>::const_iterator iter = lower_bound(_vPositions.begin(), _vPositions.end(), id, ledger_pos_id_lt());
+  return iter != _vPositions.end() && iter->id == id;
+}
+
+
+bool TradeLedger::closed(Position::ID id) const throw(TradeLedgerException)
+{
+  return _vPositions[_find(id)].size == 0;
+}
+
+
+double TradeLedger::factor(Position::ID id) const throw(TradeLedgerException)
+{
+  const LedgerPosition& pos = _vPositions[_find(id)];
+  if( pos.size != 0 )
+    throw TradeLedgerException("Position is open");
+
+  const double avgEntry = pos.entryValue / pos.entrySize;
+  const double avgExit = pos.exitValue / pos.exitSize;
+  return pos.type == Position::LONG ? avgExit / avgEntry : avgEntry / avgExit;
+}
+
+
+bool TradeLedger::hasOpen(const string& symbol) const
+{
+  map<string, unsigned>::const_iterator iter = _mSymbols.find(symbol);
+  return iter != _mSymbols.end() && _vOpenCount[iter->second] > 0;
+}
+
+
+vector<Position::ID> TradeLedger::openIds(const string& symbol) const
+{
+  vector<Position::ID> ids;
+
+  map<string, unsigned>::const_iterator iter = _mSymbols.find(symbol);
+  if( iter == _mSymbols.end() || _vOpenCount[iter->second] == 0 )
+    return ids;
+
+  // Walk the set bits only, closed stretches are skipped a word at a time
+  const Bitmap& bitmap = _vOpen[iter->second];
+  for( size_t w = 0; w < bitmap.size() && ids.size() < _vOpenCount[iter->second]; ++w ) {
+    for( boost::uint64_t bits = bitmap[w]; bits != 0; bits &= bits - 1 ) {
+      size_t bit = 0;
+      while( !( bits & ( boost::uint64_t(1) << bit ) ) ) ++bit;
+      ids.push_back(_vPositions[w * 64 + bit].id);
+    }
+  }
+
+  return ids;
+}
+
+
+PositionSet TradeLedger::positions(void) const throw(TradeLedgerException)
+{
+  if( _replayed == _vExecutions.size() )
+    return _sBuilt;
+
+  // Replay the executions recorded since the last call onto the Position objects
+  try {
+
+    for( ; _replayed < _vExecutions.size(); ++_replayed ) {
+
+      const LedgerExecution& exe = _vExecutions[_replayed];
+      const LedgerPosition& pos = _vPositions[exe.pos];
+
+      if( exe.pos == _vBuilt.size() ) {
+        if( pos.type == Position::LONG )
+          _vBuilt.push_back(PositionPtr(new LongPosition(pos.id, _vSymbols[pos.symbol], exe.dt, exe.price, exe.size)));
+        else
+          _vBuilt.push_back(PositionPtr(new ShortPosition(pos.id, _vSymbols[pos.symbol], exe.dt, exe.price, exe.size)));
+        continue;
+      }
+
+      PositionPtr pPos = _vBuilt[exe.pos];
+      switch( exe.side ) {
+        case Execution::BUY:   pPos->buy(exe.dt, exe.price, exe.size); break;
+        case Execution::SELL:  pPos->sell(exe.dt, exe.price, exe.size); break;
+        case Execution::SHORT: pPos->sell_short(exe.dt, exe.price, exe.size); break;
+        case Execution::COVER: pPos->cover(exe.dt, exe.price, exe.size); break;
+      }
+    }
+
+  } catch( const exception& ex ) {
+
+    throw TradeLedgerException(ex.what());
+  }
+
+  // Executions move the position indices, so the set is indexed again from scratch
+  _sBuilt = PositionSet();
+  for( vector<PositionPtr>::const_iterator iter = _vBuilt.begin(); iter != _vBuilt.end(); ++iter )
+    _sBuilt.insert(*iter);
+
+  return _sBuilt;
+}
+
+
+size_t TradeLedger::_find(Position::ID id) const throw(TradeLedgerException)
+{
+  vector<LedgerPosition>::const_iterator iter = lower_bound(_vPositions.begin(), _vPositions.end(), id, ledger_pos_id_lt());
+  if( iter == _vPositions.end() || iter->id != id ) {
+    stringstream ss;
+    ss << "Can't find position id " << id;
+    throw TradeLedgerException(ss.str());
+  }
+
+  return iter - _vPositions.begin();
+}
+
+
+unsigned TradeLedger::_intern(const string& symbol)
+{
+  map<string, unsigned>::const_iterator iter = _mSymbols.find(symbol);
+  if( iter != _mSymbols.end() )
+    return iter->second;
+
+  const unsigned index = _vSymbols.size();
+  _vSymbols.push_back(symbol);
+  _mSymbols.insert(make_pair(symbol, index));
+  _vOpen.push_back(Bitmap());
+  _vOpenCount.push_back(0);
+
+  return index;
+}
+
+
+void TradeLedger::_setOpen(const LedgerPosition& pos, size_t index, bool open)
+{
+  Bitmap& bitmap = _vOpen[pos.symbol];
+  if( bitmap.size() <= index / 64 )
+    bitmap.resize(index / 64 + 1, 0);
+
+  const boost::uint64_t mask = boost::uint64_t(1) << (index % 64);
+  if( open ) {
+    bitmap[index / 64] |= mask;
+    ++_vOpenCount[pos.symbol];
+  } else {
+    bitmap[index / 64] &= ~mask;
+    --_vOpenCount[pos.symbol];
+  }
+}
@@ -26,6 +26,8 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <algorithm>
+#include <vector>
 
 // Hudson
 #include "Trader.hpp"
@@ -39,24 +41,44 @@ using namespace std;
 using namespace boost::gregorian;
 using namespace boost::multi_index;
 
-Position::ID Trader::_pid = 0;
+std::atomic<Position::ID> Trader::_pid(0);
 
 
-Trader::Trader(void)
+Trader::Trader(void):
+  _ledgerMode(false)
 {
 }
 
 
+void Trader::setLedger(bool ledger) throw(TraderException)
+{
+  if( !_miPositions.empty() || !_ledger.empty() )
+    throw TraderException("Can't change trade recording after trading");
+
+  _ledgerMode = ledger;
+}
+
+
 // Buy a new position
 Position::ID Trader::buy(const string& symbol, const date& dt, const Price& price, unsigned size) throw(TraderException)
 {
   // Create new position
   PositionPtr pPos;
+  const Position::ID id = ++_pid;
+
+  if( _ledgerMode ) {
+    try {
+      _ledger.open(id, Position::LONG, symbol, dt, price, size);
+    } catch( const exception& ex ) {
+      throw TraderException(ex.what());
+    }
+    return id;
+  }
 
   // Buy position
   try {
 
-    pPos = PositionPtr(new LongPosition(++_pid, symbol, dt, price, size));
+    pPos = PositionPtr(new LongPosition(id, symbol, dt, price, size));
 
   } catch( const exception& ex ) {
 
@@ -67,14 +89,21 @@ Position::ID Trader::buy(const string& symbol, const date& dt, const Price& pric
   if( _miPositions.insert(pPos).first == _miPositions.end() )
     throw TraderException("Can't add new long position");
 
+  _indexOpen(pPos);
+
   // Return new position ID
-  return _pid;
+  return id;
 }
 
 
 // Add buy execution to an existing position
 void Trader::buy(Position::ID id, const boost::gregorian::date& dt, const Price& price, unsigned size) throw(TraderException)
 {
+  if( _ledgerMode ) {
+    _ledgerExecute(id, Execution::BUY, dt, price, size);
+    return;
+  }
+
   // Find existing position
   PositionSet::const_iterator iter = _miPositions.find(id, pos_comp_id());
   if( iter == _miPositions.end() )
@@ -96,6 +125,11 @@ void Trader::buy(Position::ID id, const boost::gregorian::date& dt, const Price&
 // Sell an existing long position
 void Trader::sell(Position::ID id, const date& dt, const Price& price, unsigned size) throw(TraderException)
 {
+  if( _ledgerMode ) {
+    _ledgerExecute(id, Execution::SELL, dt, price, size);
+    return;
+  }
+
   // Find existing position
   PositionSet::const_iterator iter = _miPositions.find(id, pos_comp_id());
   if( iter == _miPositions.end() )
@@ -111,16 +145,28 @@ void Trader::sell(Position::ID id, const date& dt, const Price& price, unsigned
 
     throw TraderException(ex.what());
   }
+
+  _closed(pPos);
 }
 
 
 Position::ID Trader::sell_short(const string& symbol, const date& dt, const Price& price, unsigned size) throw(TraderException)
 {
   PositionPtr pPos; 
+  const Position::ID id = ++_pid;
+
+  if( _ledgerMode ) {
+    try {
+      _ledger.open(id, Position::SHORT, symbol, dt, price, size);
+    } catch( const exception& ex ) {
+      throw TraderException(ex.what());
+    }
+    return id;
+  }
 
   try {
 
-    pPos = PositionPtr(new ShortPosition(++_pid, symbol, dt, price, size));
+    pPos = PositionPtr(new ShortPosition(id, symbol, dt, price, size));
 
   } catch( const exception& ex ) {
 
@@ -130,12 +176,19 @@ Position::ID Trader::sell_short(const string& symbol, const date& dt, const Pric
   if( _miPositions.insert(pPos).first == _miPositions.end() )
   	throw TraderException("Can't add short position");
 
-  return _pid;
+  _indexOpen(pPos);
+
+  return id;
 }
 
 
 void Trader::sell_short(Position::ID id, const date& dt, const Price& price, unsigned size) throw(TraderException)
 {
+  if( _ledgerMode ) {
+    _ledgerExecute(id, Execution::SHORT, dt, price, size);
+    return;
+  }
+
   // Find existing position
   PositionSet::const_iterator iter = _miPositions.find(id, pos_comp_id());
   if( iter == _miPositions.end() )
@@ -156,6 +209,11 @@ void Trader::sell_short(Position::ID id, const date& dt, const Price& price, uns
 
 void Trader::cover(Position::ID id, const date& dt, const Price& price, unsigned size) throw(TraderException)
 {
+  if( _ledgerMode ) {
+    _ledgerExecute(id, Execution::COVER, dt, price, size);
+    return;
+  }
+
   // Find existing position
   PositionSet::const_iterator iter = _miPositions.find(id, pos_comp_id());
   if( iter == _miPositions.end() )
@@ -171,11 +229,23 @@ void Trader::cover(Position::ID id, const date& dt, const Price& price, unsigned
 
     throw TraderException(ex.what());
   }
+
+  _closed(pPos);
 }
 
 
 void Trader::close(Position::ID id, const date& dt, const Price& price) throw(TraderException)
 {
+  if( _ledgerMode ) {
+    try {
+      _ledger.close(id, dt, price);
+      _stats.add(_ledger.factor(id));
+    } catch( const exception& ex ) {
+      throw TraderException(ex.what());
+    }
+    return;
+  }
+
   // Find existing position
   PositionSet::const_iterator iter = _miPositions.find(id, pos_comp_id());
   if( iter == _miPositions.end() )
@@ -191,14 +261,30 @@ void Trader::close(Position::ID id, const date& dt, const Price& price) throw(Tr
 
     throw TraderException(ex.what());
   }
+
+  _closed(pPos);
+}
+
+
+PositionSet Trader::positions(void) const throw(TraderException)
+{
+  if( !_ledgerMode )
+    return _miPositions;
+
+  try {
+    return _ledger.positions();
+  } catch( const exception& ex ) {
+    throw TraderException(ex.what());
+  }
 }
 
 
 PositionSet Trader::positions( const std::string& symbol )
 {
   PositionSet psSymbol;
+  const PositionSet all = positions();
 
-  for( PositionSet::iterator iter = _miPositions.begin(); iter != _miPositions.end(); ++iter )
+  for( PositionSet::const_iterator iter = all.begin(); iter != all.end(); ++iter )
     if( symbol == (*iter)->symbol() )
       psSymbol.insert(*iter);
 
@@ -206,8 +292,81 @@ PositionSet Trader::positions( const std::string& symbol )
 }
 
 
+bool Trader::hasOpen( const std::string& symbol ) const
+{
+  if( _ledgerMode )
+    return _ledger.hasOpen(symbol);
+
+  OpenIndex::iterator iter = _mOpen.find(symbol);
+  if( iter == _mOpen.end() )
+    return false;
+
+  _pruneOpen(iter->second);
+  return !iter->second.empty();
+}
+
+
+vector<Position::ID> Trader::openIds( const std::string& symbol ) const
+{
+  if( _ledgerMode )
+    return _ledger.openIds(symbol);
+
+  vector<Position::ID> ids;
+  OpenIndex::iterator iter = _mOpen.find(symbol);
+  if( iter == _mOpen.end() )
+    return ids;
+
+  _pruneOpen(iter->second);
+  for( vector<PositionPtr>::const_iterator piter = iter->second.begin(); piter != iter->second.end(); ++piter )
+    ids.push_back((*piter)->id());
+
+  sort(ids.begin(), ids.end());
+  return ids;
+}
+
+
+void Trader::_indexOpen( const PositionPtr& pPos )
+{
+  _mOpen[pPos->symbol()].push_back(pPos);
+}
+
+
+void Trader::_closed( const PositionPtr& pPos )
+{
+  if( pPos->closed() )
+    _stats.add(pPos->factor());
+}
+
+
+// Closed positions never reopen, so dropping them on lookup keeps the index exact even when a
+// position is closed outside of this Trader, like StrategyPosition legs.
+void Trader::_pruneOpen( vector<PositionPtr>& vOpen ) const
+{
+  vOpen.erase(remove_if(vOpen.begin(), vOpen.end(), pos_is_closed()), vOpen.end());
+}
+
+
+void Trader::_ledgerExecute( Position::ID id, Execution::Side side, const date& dt, const Price& price, unsigned size ) throw(TraderException)
+{
+  try {
+    _ledger.execute(id, side, dt, price, size);
+    if( _ledger.closed(id) )
+      _stats.add(_ledger.factor(id));
+  } catch( const exception& ex ) {
+    throw TraderException(ex.what());
+  }
+}
+
+
 PositionPtr Trader::get( Position::ID id ) const throw(TraderException)
 {
+  if( _ledgerMode ) {
+    const PositionSet all = positions();
+    PositionSet::const_iterator citer = all.find(id, pos_comp_id());
+    if( citer != all.end() )
+      return *citer;
+  }
+
   PositionSet::const_iterator citer = _miPositions.find(id, pos_comp_id());
   if( citer == _miPositions.end() ) {
     stringstream ss;
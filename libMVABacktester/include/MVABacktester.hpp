@@ -27,16 +27,20 @@
 
 // Boost
 #include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/shared_ptr.hpp>
 
 // Hudson
 #include <EODSeries.hpp>
 #include <Trader.hpp>
 #include <IndicatorApp.hpp>
 #include "TMVAReader.hpp"
+#include "SignalScan.hpp"
 
 // ROOT
 #include "TRandom3.h"
 
+namespace TMVA { class Timer; }
+
 //! Asset Allocator Trader.
 /*!
   MVABacktester trades using a evaluated MVA output. SP500.
@@ -49,7 +53,7 @@ public:
     The constructor gets historical data series for different asset classes.
     \param spx_db SP500 historical data
   */
-  explicit MVABacktester(const Series::EODSeries& db, const IndicatorApp app, const std::string& mva, const Float_t& cutValue=0.1 );
+  explicit MVABacktester(const Series::EODSeries& db, const IndicatorApp& app, const std::string& mva, const Float_t& cutValue=0.1 );
 
   //! Run the trader.
   void run( const unsigned& dayshift = 7, const MVABacktester::Type& type = MVABasic ) throw(TraderException);
@@ -65,7 +69,33 @@ public:
   */
   void setup( const std::vector< std::string >& inputvars, const std::set< std::pair< std::string, std::string > >& leaves, const std::string& outputFile = "outputFile.root", const std::string& weightsDirPrefix = "weights");
 
+  /*!
+    Trade on precomputed MVA values instead of evaluating the reader bar by bar.
+    \param scores one value per bar of the series from IndicatorApp::getStartIdx() on, NaN for no trade
+  */
+  void setScores( const boost::shared_ptr< const std::vector< Float_t > >& scores );
+
+  /*!
+    Evaluate many cut values on the scores set with setScores without running the trader.
+    Each bar passing a cut opens a position at the next open and closes it dayshift bars
+    later, as run() does. Only MVABasic and ProbTransform depend on the cut.
+  */
+  std::vector< ScanResult > scan( const std::vector< Float_t >& cuts, const unsigned& dayshift = 7, const MVABacktester::Type& type = MVABasic ) const;
+
+  /*!
+    Per bar score and trade factor as scan() uses them, the input of SignalScan and SignalBootstrap.
+    \param scores score compared with the cut, transformed for ProbTransform
+    \param factors exit over entry open of the trade opened on the bar, NaN outside the period or the series
+  */
+  void tradeFactors( std::vector< Float_t >& scores, std::vector< double >& factors, const unsigned& dayshift = 7, const MVABacktester::Type& type = MVABasic ) const;
+
+  //! Only open positions on bars inside the period, the whole series by default.
+  void setPeriod( const boost::gregorian::date_period& period ) { m_period = period; }
+
   void setCutValue( const Float_t& value ) { m_cutValue = value; }
+
+  //! Print trades and the progress bar, on by default. Switch off when running many backtesters at once.
+  void setVerbose( const bool& verbose = true ) { m_verbose = verbose; }
   /*!
     Run trading loop over select calendar period. Called for each asset class.
     \param db historical data
@@ -73,7 +103,12 @@ public:
     \param sma simple moving average series
   */
 private:
-  void trade( Series::EODSeries::const_iterator& iter);
+  void trade( Series::EODSeries::const_iterator& iter, const std::size_t& row );
+  /*!
+    Trade the precomputed scores on row indices into the series columns, without
+    map lookups. Same trades as calling trade() on every bar.
+  */
+  void trade_rows( const boost::shared_ptr< TMVA::Timer >& timer, const int& progressStep );
   /*!
     Execute the buy strategy
     \param db historical data
@@ -94,14 +129,17 @@ private:
 private:
 
   const Series::EODSeries& m_db;
-  IndicatorApp m_app;
+  const IndicatorApp& m_app;
   std::string m_mvaName;
   unsigned m_dayshift;
   Float_t m_cutValue;
   bool m_setup;
+  bool m_verbose;
   NN::TMVAReader* m_reader;
   std::vector<std::string> m_inputvars;
   std::set< std::pair< std::string, std::string > > m_leaves;
+  boost::shared_ptr< const std::vector< Float_t > > m_scores;
+  boost::gregorian::date_period m_period;
   TRandom3 m_random;
   Type m_type;
 };
@@ -0,0 +1,117 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MVACUTSWEEP_HPP_
+#define _MVACUTSWEEP_HPP_ 1
+
+// STL
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Hudson
+#include <EODSeries.hpp>
+#include <IndicatorApp.hpp>
+#include <ReportTable.hpp>
+#include "MVABacktester.hpp"
+
+//! Statistics of one backtest in a cut sweep, as mvabacktest writes them.
+struct CutResult
+{
+  Float_t cut;
+  UInt_t seed;
+  bool ok;
+  double roi;        //!< ReturnFactors over all positions
+  double stddev;
+  double skew;
+  double avg;
+  double maxdd;      //!< ROI of the drawdown positions
+  int nPositions;
+  double sharpe;     //!< EOMReturnFactors over the trading period
+  double roiEOM;
+  double cagr;
+  double gsdm;
+};
+
+//! Parallel MVA cut scan.
+/*!
+  MVACutSweep runs one MVABacktester per cut value on scores computed once,
+  see MVAPipeline::score. The series, indicators and scores are only read,
+  so the backtests share them and run on a pool of threads. Each thread
+  owns its backtester and its positions.
+*/
+class MVACutSweep
+{
+public:
+  /*!
+    \param db historical data
+    \param app initialised indicators on db
+    \param mva name of the scored method
+    \param scores one value per bar from IndicatorApp::getStartIdx() on
+    \param begin begin of the monthly return periods
+    \param end end of the monthly return periods
+  */
+  MVACutSweep( const Series::EODSeries& db, const IndicatorApp& app, const std::string& mva, const boost::shared_ptr< const std::vector< Float_t > >& scores,
+               const boost::gregorian::date& begin, const boost::gregorian::date& end, double rf_rate = 3.0 );
+
+  /*!
+    Backtest every cut value.
+    \param cuts MVA cut values
+    \param seeds random seeds, one per cut, only used by MVABacktester::Random
+    \param nThreads number of concurrent backtests, 0 uses all cores
+  */
+  void run( const std::vector< Float_t >& cuts, const std::vector< UInt_t >& seeds, const unsigned& dayshift = 7,
+            const MVABacktester::Type& type = MVABacktester::MVABasic, unsigned nThreads = 0 );
+
+  /*!
+    Statistics of a backtest that has already run, as run() collects them.
+    \param backtester a backtester on the series and scores of this sweep
+  */
+  CutResult evaluate( MVABacktester& backtester, const Float_t& cut, const UInt_t& seed ) const;
+
+  //! One row per cut, in the order the cuts were given.
+  const std::vector< CutResult >& results( void ) const { return m_results; }
+
+  //! Print the result table.
+  void print( void ) const;
+  //! The results as a ReportTable, one row per cut, to write with a ReportSink.
+  ReportTable table( void ) const;
+
+private:
+  void worker( const std::vector< Float_t >& cuts, const std::vector< UInt_t >& seeds, const unsigned& dayshift, const MVABacktester::Type& type );
+  CutResult backtest( const Float_t& cut, const UInt_t& seed, const unsigned& dayshift, const MVABacktester::Type& type ) const;
+
+private:
+  const Series::EODSeries& m_db;
+  const IndicatorApp& m_app;
+  std::string m_mvaName;
+  boost::shared_ptr< const std::vector< Float_t > > m_scores;
+  boost::gregorian::date m_begin;
+  boost::gregorian::date m_end;
+  double m_rf_rate;
+
+  std::vector< CutResult > m_results;
+  std::atomic< std::size_t > m_next;
+};
+
+#endif // _MVACUTSWEEP_HPP_
@@ -0,0 +1,101 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MVAPIPELINE_HPP_
+#define _MVAPIPELINE_HPP_ 1
+
+// STL
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Boost
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Hudson
+#include <EODSeries.hpp>
+#include <IndicatorApp.hpp>
+#include "FeatureMatrix.hpp"
+
+//! In-memory MVA workflow.
+/*!
+  MVAPipeline does the work of maketuple, mva and mvabacktest without the
+  intermediate ROOT files. The indicators are read once into a feature
+  matrix together with the signal and background labels, the classifiers
+  are trained on a calendar period of that matrix and every bar is then
+  scored in one batch. The scores are handed to MVABacktester::setScores.
+  A tuple with the same layout as maketuple's can still be written as an
+  artifact.
+*/
+class MVAPipeline
+{
+public:
+  /*!
+    \param db historical data
+    \param app initialised indicators on db
+    \param leaves indicator and extension pairs making the feature columns
+    \param dayshift number of bars ahead used to label a bar as signal or background
+  */
+  MVAPipeline( const Series::EODSeries& db, const IndicatorApp& app, const std::set< std::pair< std::string, std::string > >& leaves, const unsigned& dayshift = 7 );
+
+  //! Fill the feature matrix and the labels, one row per bar from IndicatorApp::getStartIdx() on.
+  void initialise();
+
+  /*!
+    Train the methods on the labelled bars inside the period.
+    \param options option strings overriding the DefinedMVAs defaults, by method
+    \return false if the training failed
+  */
+  bool train( const std::vector< std::string >& methods, const std::vector< std::string >& inputvars, const boost::gregorian::date_period& period,
+              const std::string& outputFile = "TMVA.root", const std::string& weightsDir = "weights",
+              const std::map< std::string, std::string >& options = std::map< std::string, std::string >() );
+
+  //! Score every bar with a trained method, the result lines up with MVABacktester::setScores.
+  boost::shared_ptr< const std::vector< Float_t > > score( const std::string& method, const std::vector< std::string >& inputvars, const std::string& weightsDir = "weights" );
+
+  //! Write the maketuple columns plus a nn_<method> column for every scored method.
+  void writeTuple( const std::string& filename, const std::string& treepath = "data" ) const;
+
+  const NN::FeatureMatrix& features() const { return m_features; }
+  const std::vector< boost::gregorian::date >& dates() const { return m_dates; }
+  const unsigned& dayshift() const { return m_dayshift; }
+  //! Price change over dayshift bars, NaN where the bar can't be labelled.
+  const std::vector< double >& changes() const { return m_change; }
+
+private:
+  //! maketuple's nsig, nbkg, nsig_S_sw and nbkg_B_sw for a row, false if the row is not labelled.
+  bool labels( const std::size_t& row, Float_t& nsig, Float_t& nbkg, Float_t& nsig_S_sw, Float_t& nbkg_B_sw ) const;
+
+private:
+  const Series::EODSeries& m_db;
+  const IndicatorApp& m_app;
+  std::set< std::pair< std::string, std::string > > m_leaves;
+  unsigned m_dayshift;
+
+  NN::FeatureMatrix m_features;
+  std::vector< boost::gregorian::date > m_dates;
+  std::vector< double > m_close;
+  std::vector< double > m_change;
+  std::map< std::string, boost::shared_ptr< const std::vector< Float_t > > > m_scores;
+};
+
+#endif // _MVAPIPELINE_HPP_
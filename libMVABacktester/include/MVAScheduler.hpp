@@ -0,0 +1,135 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _MVASCHEDULER_HPP_
+#define _MVASCHEDULER_HPP_ 1
+
+// STL
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Hudson
+#include <IndicatorApp.hpp>
+#include <EOMReturnFactors.hpp>
+#include <PortfolioReturns.hpp>
+#include "MVABacktester.hpp"
+
+//! One asset and strategy to backtest.
+struct MVAJob
+{
+  MVAJob( void ): app( 0 ), cut( 0.1 ), dayshift( 7 ), type( MVABacktester::MVABasic ), seed( 7 ), weight( 0 ) { }
+
+  std::string symbol;                                       //!< series name in EODDB
+  const IndicatorApp* app;                                  //!< initialised indicators on the series
+  std::string mva;                                          //!< name of the scored method
+  boost::shared_ptr< const std::vector< Float_t > > scores; //!< one value per bar from IndicatorApp::getStartIdx() on
+  Float_t cut;
+  unsigned dayshift;
+  MVABacktester::Type type;
+  UInt_t seed;
+  double weight;                                            //!< portfolio weight, see PortfolioReturns::add
+};
+
+//! Statistics of one scheduled backtest.
+struct MVAJobResult
+{
+  std::string symbol;
+  std::string mva;
+  Float_t cut;
+  bool ok;
+  int nPositions;
+  double roi;        //!< ReturnFactors over all positions
+  double sharpe;     //!< EOMReturnFactors over the trading period
+  double roiEOM;
+  double cagr;
+  double gsdm;
+};
+
+//! Concurrent backtests of many assets and strategies.
+/*!
+  MVAScheduler runs one MVABacktester per job on a work-stealing pool of
+  threads. Jobs are dealt round robin to per-thread queues; a thread takes
+  its own jobs from the back and, once its queue is empty, steals from the
+  front of the others, so short series do not leave threads idle.
+
+  Series, indicators and scores are only read and may be shared between
+  jobs. Score the bars beforehand, see MVAPipeline::score; TMVA readers
+  are not used in the threads. Each job trades in its own ledger and its
+  monthly returns are combined by portfolio().
+*/
+class MVAScheduler
+{
+public:
+  /*!
+    \param begin begin of the trading and monthly return periods
+    \param end end of the trading and monthly return periods
+  */
+  MVAScheduler( const boost::gregorian::date& begin, const boost::gregorian::date& end, double rf_rate = 3.0 );
+
+  //! Queue a job, returns its index in results().
+  std::size_t add( const MVAJob& job );
+
+  /*!
+    Backtest all queued jobs.
+    \param nThreads number of concurrent backtests, 0 uses all cores
+  */
+  void run( unsigned nThreads = 0 );
+
+  //! One row per job, in the order the jobs were added.
+  const std::vector< MVAJobResult >& results( void ) const { return m_results; }
+
+  //! Monthly returns of a finished job, empty if it failed.
+  boost::shared_ptr< const EOMReturnFactors > factors( const std::size_t& job ) const { return m_factors.at( job ); }
+
+  /*!
+    Aggregate the monthly returns of all successful jobs with their weights.
+    The returned object points into this scheduler and must not outlive it.
+  */
+  PortfolioReturns portfolio( void ) const throw(PortfolioReturnsException);
+
+  //! Print the result table and the portfolio statistics.
+  void print( void ) const;
+
+private:
+  void worker( const unsigned& self );
+  bool next( const unsigned& self, std::size_t& job );
+  void backtest( const std::size_t& job );
+
+private:
+  boost::gregorian::date m_begin;
+  boost::gregorian::date m_end;
+  double m_rf_rate;
+
+  std::vector< MVAJob > m_jobs;
+  std::vector< MVAJobResult > m_results;
+  std::vector< boost::shared_ptr< EOMReturnFactors > > m_factors;
+
+  std::vector< std::deque< std::size_t > > m_queues;
+  std::unique_ptr< std::mutex[] > m_locks;
+};
+
+#endif // _MVASCHEDULER_HPP_
@@ -0,0 +1,136 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _SIGNALBOOTSTRAP_HPP_
+#define _SIGNALBOOTSTRAP_HPP_ 1
+
+// STL
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// ROOT
+#include "Rtypes.h"
+
+//! Counter-based random numbers.
+/*!
+  The n-th number of a stream is a hash of (seed, stream, n), so a path
+  draws the same numbers whatever thread runs it and in whatever order.
+  The mixing function is SplitMix64's finaliser.
+*/
+class CounterRNG
+{
+public:
+  CounterRNG( const uint64_t& seed, const uint64_t& stream ): m_key( mix( seed ^ mix( stream + 0x9E3779B97F4A7C15ULL ) ) ), m_counter( 0 ) { }
+
+  uint64_t next( void ) { return mix( m_key + 0x9E3779B97F4A7C15ULL * ++m_counter ); }
+  //! Uniform in [0, 1).
+  double uniform( void ) { return ( next() >> 11 ) * ( 1.0 / 9007199254740992.0 ); }
+  //! Uniform integer in [0, n).
+  uint64_t below( const uint64_t& n ) { return static_cast< uint64_t >( uniform() * n ); }
+
+private:
+  static uint64_t mix( uint64_t z )
+  {
+    z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+    return z ^ ( z >> 31 );
+  }
+
+  uint64_t m_key;
+  uint64_t m_counter;
+};
+
+//! Mean and two-sided confidence interval of a resampled statistic.
+struct BootstrapInterval
+{
+  double mean;
+  double lower;
+  double upper;
+};
+
+//! Resampled ROI and drawdown of one cut value.
+struct BootstrapResult
+{
+  Float_t cut;
+  int nPositions;           //!< trades of the strategy, and of every resampled path
+  double roi;               //!< strategy compounded factor - 1
+  double maxdd;             //!< strategy worst compounded run - 1
+  BootstrapInterval roiCI;
+  BootstrapInterval maxddCI;
+  double pValue;            //!< RandomEntry: fraction of paths with a ROI at least the strategy's, NaN for BlockBootstrap
+};
+
+//! Monte Carlo robustness test over a precomputed signal.
+/*!
+  SignalBootstrap works on the same score and trade factor arrays as
+  SignalScan and resamples them into alternative trade sequences without
+  running a backtester:
+
+  - BlockBootstrap draws the strategy's own trade factors in blocks of
+    consecutive trades, keeping short range dependence, until a path has
+    as many trades as the strategy.
+  - RandomEntry opens the same number of trades on bars picked uniformly
+    among all tradable bars, the null hypothesis of MVABacktester::Random
+    with the trade count held fixed. Only these paths give a p-value.
+
+  Paths are spread over threads and each path has its own CounterRNG
+  stream, so results only depend on the seed.
+*/
+class SignalBootstrap
+{
+public:
+  enum Mode { BlockBootstrap = 0, RandomEntry };
+
+  /*!
+    \param scores signal value per bar, NaN for no trade
+    \param factors exit over entry price of the trade opened on the bar, NaN if it can't be opened or closed
+  */
+  SignalBootstrap( const std::vector< Float_t >& scores, const std::vector< double >& factors );
+
+  /*!
+    Resample the trades passing cut.
+    \param blockLength trades per block, BlockBootstrap only
+    \param confidence two-sided level of the intervals
+    \param nThreads number of threads, 0 uses all cores
+  */
+  BootstrapResult run( const Float_t& cut, const Mode& mode = BlockBootstrap, const unsigned& nPaths = 10000, const unsigned& blockLength = 5,
+                       const double& confidence = 0.95, const uint64_t& seed = 7, unsigned nThreads = 0 );
+
+  //! ROI of every path of the last run.
+  const std::vector< double >& roi( void ) const { return m_roi; }
+  //! Drawdown of every path of the last run.
+  const std::vector< double >& maxdd( void ) const { return m_maxdd; }
+
+private:
+  void worker( const std::vector< double >& selected, const Mode& mode, const unsigned& blockLength, const uint64_t& seed );
+  static BootstrapInterval interval( std::vector< double > values, const double& confidence );
+
+private:
+  std::vector< Float_t > m_scores;
+  std::vector< double > m_factors;
+  std::vector< std::size_t > m_tradable;  //!< bars with a known trade factor
+
+  std::vector< double > m_roi;
+  std::vector< double > m_maxdd;
+  std::atomic< std::size_t > m_next;
+};
+
+#endif // _SIGNALBOOTSTRAP_HPP_
@@ -0,0 +1,70 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SIGNALSCAN_HPP_
+#define _SIGNALSCAN_HPP_ 1
+
+// STL
+#include <vector>
+
+// ROOT
+#include "Rtypes.h"
+
+//! Trade statistics of one cut value, with the ReturnFactors definitions.
+struct ScanResult
+{
+  Float_t cut;
+  int nPositions;
+  double roi;     //!< compounded factor - 1
+  double avg;     //!< mean factor - 1
+  double stddev;  //!< sample standard deviation of the factors
+  double skew;
+  double maxdd;   //!< worst compounded run of consecutive trades - 1, 0 if none
+};
+
+//! Threshold scan over a precomputed signal.
+/*!
+  SignalScan evaluates many cut values on one score series without
+  simulating positions. Bar i trades when scores[i] >= cut and its trade
+  factor is known; the trade returns factors[i]. Every bar is therefore an
+  independent entry, as in MVABacktester where each position is closed
+  before the next bar is looked at. A cut is a masked pass over two
+  contiguous arrays, so a scan costs cuts x bars comparisons.
+*/
+class SignalScan
+{
+public:
+  /*!
+    \param scores signal value per bar, NaN for no trade
+    \param factors exit over entry price of the trade opened on the bar, NaN if it can't be opened or closed
+  */
+  SignalScan( const std::vector< Float_t >& scores, const std::vector< double >& factors );
+
+  //! Statistics for every cut value.
+  std::vector< ScanResult > run( const std::vector< Float_t >& cuts ) const;
+
+  //! Statistics for one cut value.
+  ScanResult evaluate( const Float_t& cut ) const;
+
+private:
+  std::vector< Float_t > m_scores;
+  std::vector< double > m_factors;
+};
+
+#endif // _SIGNALSCAN_HPP_
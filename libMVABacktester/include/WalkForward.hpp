@@ -0,0 +1,116 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _WALKFORWARD_HPP_
+#define _WALKFORWARD_HPP_ 1
+
+// STL
+#include <map>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Hudson
+#include <EODSeries.hpp>
+#include <IndicatorApp.hpp>
+#include <PositionSet.hpp>
+#include "MVABacktester.hpp"
+#include "MVAPipeline.hpp"
+
+//! One train and test window of a walk-forward run.
+struct WalkForwardFold
+{
+  boost::gregorian::date_period train;  //!< labelled bars used for training, purged before test
+  boost::gregorian::date_period test;   //!< out-of-sample bars traded with this fold's weights
+  std::string dir;                      //!< TMVA output and weights of the fold
+  bool ok;
+  int nPositions;                       //!< positions opened inside test
+  double roi;                           //!< compounded factor - 1 of those positions
+};
+
+//! Walk-forward retraining and backtesting.
+/*!
+  WalkForward slides a train/test window over the series. Every fold is
+  trained on its window with MVAPipeline, its test bars are scored with
+  the fold's weights and the scores of all test windows are stitched into
+  one out-of-sample series, which a single MVABacktester then trades.
+
+  The indicators and the feature matrix are computed once by the
+  pipeline and shared by all folds. A bar's label looks dayshift + 1 bars
+  ahead, so the training window ends that many bars before the test
+  window starts. TMVA keeps global state, folds are therefore trained in
+  forked worker processes, each in its own directory <jobDir>/fold_<n>.
+  Train before opening any writable ROOT file in the parent.
+*/
+class WalkForward
+{
+public:
+  /*!
+    \param db historical data
+    \param app initialised indicators on db
+    \param pipeline initialised pipeline on db and app
+    \param jobDir directory holding the fold directories
+  */
+  WalkForward( const Series::EODSeries& db, const IndicatorApp& app, MVAPipeline& pipeline, const std::string& jobDir = "walkforward" );
+
+  /*!
+    Split [begin, end) into folds of trainMonths training followed by testMonths testing.
+    The window moves by testMonths, so the test periods cover the range without overlapping.
+    \param anchored keep the training window start at begin instead of sliding it
+  */
+  void setFolds( const boost::gregorian::date& begin, const boost::gregorian::date& end, const unsigned& trainMonths, const unsigned& testMonths, const bool& anchored = false );
+
+  /*!
+    Train every fold with at most nWorkers running at once.
+    \return false if any fold failed
+  */
+  bool train( const std::vector< std::string >& methods, const std::vector< std::string >& inputvars, const unsigned& nWorkers = 1,
+              const std::map< std::string, std::string >& options = std::map< std::string, std::string >() );
+
+  //! Out-of-sample scores: every test bar scored by its fold, NaN elsewhere and for failed folds.
+  boost::shared_ptr< const std::vector< Float_t > > score( const std::string& method, const std::vector< std::string >& inputvars );
+
+  //! Trade the stitched scores over all test windows and fill the fold statistics.
+  void backtest( const std::string& method, const Float_t& cut, const MVABacktester::Type& type = MVABacktester::MVABasic, const UInt_t& seed = 7 );
+
+  const std::vector< WalkForwardFold >& folds() const { return m_folds; }
+  //! Positions of the last backtest, the out-of-sample equity curve.
+  const PositionSet& positions() const { return m_positions; }
+  //! First test day to the end of the last test window.
+  boost::gregorian::date_period period() const;
+
+  //! Print the fold table.
+  void print() const;
+
+private:
+  const Series::EODSeries& m_db;
+  const IndicatorApp& m_app;
+  MVAPipeline& m_pipeline;
+  std::string m_jobDir;
+
+  std::vector< WalkForwardFold > m_folds;
+  boost::shared_ptr< const std::vector< Float_t > > m_scores;
+  PositionSet m_positions;
+};
+
+#endif // _WALKFORWARD_HPP_
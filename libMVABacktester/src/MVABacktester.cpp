@@ -18,7 +18,10 @@
  */
  
 // STL
+#include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <limits>
 
 // Hudson
 #include "MVABacktester.hpp"
@@ -29,7 +32,7 @@ using namespace boost::gregorian;
 using namespace Series;
 
 
-MVABacktester::MVABacktester( const EODSeries& db, const IndicatorApp app, const std::string& mva, const Float_t& cutValue)
+MVABacktester::MVABacktester( const EODSeries& db, const IndicatorApp& app, const std::string& mva, const Float_t& cutValue)
  :
   m_db( db ),
   m_app( app ),
@@ -37,7 +40,9 @@ MVABacktester::MVABacktester( const EODSeries& db, const IndicatorApp app, const
   m_dayshift( 0 ),
   m_cutValue( cutValue ),
   m_setup( false ),
+  m_verbose( true ),
   m_reader( 0 ),
+  m_period( db.period() ),
   m_random( 100 )
 {
 }
@@ -48,6 +53,81 @@ void MVABacktester::setSeed( const UInt_t& seed )
 }
 
 
+void MVABacktester::setScores( const boost::shared_ptr< const std::vector< Float_t > >& scores )
+{
+  const std::size_t rows = m_app.getStartIdx() < static_cast<int>( m_db.size() ) ? m_db.size() - m_app.getStartIdx() : 0;
+  if( !scores || scores->size() != rows ) {
+    std::cerr << "MVABacktester: setScores - expected " << rows << " scores, one per bar from the indicator start.\n";
+    exit(EXIT_FAILURE);
+  }
+  m_scores = scores;
+  m_setup = true;
+}
+
+
+std::vector< ScanResult > MVABacktester::scan( const std::vector< Float_t >& cuts, const unsigned& dayshift, const MVABacktester::Type& type ) const
+{
+  if( type == Random || dayshift == 0 ) {
+    std::cerr << "MVABacktester: scan - random cuts and a zero day shift can't be scanned, use run.\n";
+    return std::vector< ScanResult >();
+  }
+
+  std::vector< Float_t > scores;
+  std::vector< double > factors;
+  tradeFactors( scores, factors, dayshift, type );
+
+  return SignalScan( scores, factors ).run( cuts );
+}
+
+
+void MVABacktester::tradeFactors( std::vector< Float_t >& scores, std::vector< double >& factors, const unsigned& dayshift, const MVABacktester::Type& type ) const
+{
+  if( !m_scores ) {
+    std::cerr << "MVABacktester: tradeFactors - needs the scores from setScores.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Score and trade factor for every bar: buy at the next open, sell at the open dayshift bars later
+  const std::size_t rows = m_scores->size();
+  scores.assign( rows, 0. );
+  factors.assign( rows, std::numeric_limits<double>::quiet_NaN() );
+
+  if( m_db.hasColumns() ) {
+    const std::vector< date >& dates = m_db.dates();
+    const std::vector< double >& open = m_db.openColumn();
+    const std::size_t start = m_app.getStartIdx();
+    const std::size_t nRows = dates.size();
+    for( std::size_t i = 0; i < rows; ++i ) {
+      const Float_t score = (*m_scores)[i];
+      scores[i] = ( type == ProbTransform ) ? 0.5*(1.0 + score ) : score;
+
+      const std::size_t bar = start + i, entry = bar + 1, exit = bar + dayshift;
+      if( !m_period.contains( dates[bar] ) || entry >= nRows || exit >= nRows ) continue;
+      factors[i] = open[exit] / open[entry];
+    }
+    return;
+  }
+
+  // Columns missing: walk the series map
+  Series::EODSeries::const_iterator iter( m_db.begin() );
+  std::advance( iter, m_app.getStartIdx() );
+  std::ptrdiff_t remaining = std::distance( iter, m_db.end() );
+  for( std::size_t i = 0; i < rows; ++iter, ++i, --remaining ) {
+    const Float_t score = (*m_scores)[i];
+    scores[i] = ( type == ProbTransform ) ? 0.5*(1.0 + score ) : score;
+
+    if( !m_period.contains( iter->first ) ) continue;
+    Series::EODSeries::const_iterator iter_entry = iter, iter_exit = iter;
+    std::advance( iter_entry, 1 );
+    if( iter_entry == m_db.end() ) continue;
+    if( remaining <= (std::ptrdiff_t)dayshift ) continue;
+    std::advance( iter_exit, dayshift );
+    factors[i] = iter_exit->second.open / iter_entry->second.open;
+  }
+}
+
+
 void MVABacktester::run( const unsigned& dayshift, const MVABacktester::Type& type ) throw(TraderException)
 {
 
@@ -62,13 +142,23 @@ void MVABacktester::run( const unsigned& dayshift, const MVABacktester::Type& ty
   Series::EODSeries::const_iterator iter( m_db.begin() ); 
 
   std::advance( iter, m_app.getStartIdx() ); 
-  TMVA::Timer timer( std::distance(iter, m_db.end() ), "MVABacktester", kTRUE ); 
+  const int nBars = std::distance(iter, m_db.end() );
+  boost::shared_ptr< TMVA::Timer > timer;
+  if( m_verbose ) timer.reset( new TMVA::Timer( nBars, "MVABacktester", kTRUE ) );
+  // Redraw the progress bar about every percent
+  const int progressStep = std::max( nBars / 100, 1 );
+
+  if( m_scores && m_db.hasColumns() ) {
+    trade_rows( timer, progressStep );
+    return;
+  }
 
   for( int i = 0; iter != m_db.end(); ++iter, ++i ) {
     try {
 
-      trade( iter );
-      timer.DrawProgressBar( i );
+      if( m_period.contains( iter->first ) )
+        trade( iter, i );
+      if( timer && i % progressStep == 0 ) timer->DrawProgressBar( i );
     } catch( std::exception& e ) {
 
       cerr << e.what() << endl;
@@ -78,20 +168,87 @@ void MVABacktester::run( const unsigned& dayshift, const MVABacktester::Type& ty
 }
 
 
-void MVABacktester::trade( Series::EODSeries::const_iterator& iter )
+void MVABacktester::trade_rows( const boost::shared_ptr< TMVA::Timer >& timer, const int& progressStep )
+{
+  const std::vector< date >& dates = m_db.dates();
+  const std::vector< double >& open = m_db.openColumn();
+  const std::vector< Float_t >& scores = *m_scores;
+  const std::size_t start = m_app.getStartIdx();
+  const std::size_t nRows = dates.size();
+  const std::string& symbol = m_db.name();
+
+  for( std::size_t row = 0; row < scores.size(); ++row ) {
+
+    if( timer && row % progressStep == 0 ) timer->DrawProgressBar( row );
+
+    const std::size_t bar = start + row;
+    const Float_t score = scores[row];
+    if( std::isnan( score ) || !m_period.contains( dates[bar] ) ) continue;
+
+    Float_t mvaValue( score );
+    if( m_type == Random )
+      mvaValue = m_random.Uniform(-1.1, 1.1);
+    else if( m_type == ProbTransform )
+      mvaValue = 0.5*(1.0 + score );
+
+    // Buy at the next open and sell at the open m_dayshift bars from now, as check_buy does
+    const std::size_t entry = bar + 1, exit = bar + m_dayshift;
+    if( mvaValue < m_cutValue || exit >= nRows || hasOpen( symbol ) ) continue;
+    if( entry >= nRows ) {
+      cerr << "Warning: can't open " << symbol << " position after " << dates[bar] << endl;
+      continue;
+    }
+
+    try {
+
+      if( m_verbose ) cout << "Buying on " << dates[entry] << " at " << open[entry] << endl;
+      buy( symbol, dates[entry], Price( open[entry] ) );
+
+      const std::vector<Position::ID> ids = openIds( symbol );
+      for( std::vector<Position::ID>::const_iterator id_iter = ids.begin(); id_iter != ids.end(); ++id_iter )
+        close( *id_iter, dates[exit], Price( open[exit] ) );
+
+    } catch( std::exception& e ) {
+
+      cerr << e.what() << endl;
+    }
+  }
+}
+
+
+void MVABacktester::trade( Series::EODSeries::const_iterator& iter, const std::size_t& row )
 {
   Float_t mvaValue(0.0), value(0.0);//, error(0.);
 
+  // precomputed values replace the reader, the types transform them the same way
+  if( m_scores ) {
+    const Float_t score = (*m_scores)[row];
+    if( std::isnan( score ) ) return;
+    switch ( m_type ) {
+      case Random:
+        mvaValue = m_random.Uniform(-1.1, 1.1);
+        break;
+      case ProbTransform:
+        mvaValue = 0.5*(1.0 + score );
+        break;
+      default:
+        mvaValue = score;
+        break;
+    }
+    check_buy( iter, mvaValue );
+    return;
+  }
+
   // now loop over leaves and set the values
   for ( std::set< std::pair< std::string, std::string > >::const_iterator p = m_leaves.begin( ); p != m_leaves.end( ); ++p ) {
-    value = static_cast<Float_t>( m_app.evaluateAtOrBefore( p->first, iter->first, p->second ) );
+    value = static_cast<Float_t>( m_app.value( p->first, iter->first, p->second ) );
     if( p->second != "" ) {
       m_reader->setVariable( p->first+"_"+p->second, value );
     } else {
       m_reader->setVariable( p->first, value );
     }
     if( p->first == "STOCHRSIDK" ) {
-      m_reader->setVariable( "STOCHRSIDK", m_app.evaluateAtOrBefore( "STOCHRSI", iter->first, "D" ) - m_app.evaluateAtOrBefore( "STOCHRSI", iter->first, "K" ) );
+      m_reader->setVariable( "STOCHRSIDK", m_app.value( "STOCHRSI", iter->first, "D" ) - m_app.value( "STOCHRSI", iter->first, "K" ) );
     }
   }
 
@@ -140,7 +297,7 @@ void MVABacktester::setup( const std::vector< std::string >& inputvars, const st
 void MVABacktester::check_buy( Series::EODSeries::const_iterator& iter, const Float_t& value )
 {
   // Buy on MACD cross and MACD Hist > 0.5%
-  if( _miPositions.open( m_db.name() ).empty() && 
+  if( !hasOpen( m_db.name() ) && 
        m_db.after( iter->first, m_dayshift ) != m_db.end() ) {
    
     if( value < m_cutValue ) return;
@@ -152,7 +309,7 @@ void MVABacktester::check_buy( Series::EODSeries::const_iterator& iter, const Fl
       cerr << "Warning: can't open " << m_db.name() << " position after " << iter->first << endl;
       return;
     }
-    cout << "Buying on " << iter_entry->first << " at " << iter_entry->second.open << endl;
+    if( m_verbose ) cout << "Buying on " << iter_entry->first << " at " << iter_entry->second.open << endl;
     buy( m_db.name(), iter_entry->first, Price( iter_entry->second.open ) );
 
     // Sell m_dayshift days from now!
@@ -162,12 +319,11 @@ void MVABacktester::check_buy( Series::EODSeries::const_iterator& iter, const Fl
       return;
     }
     // Close all open positions at tomorrow's open
-    PositionSet ps = _miPositions.open( m_db.name() );
-    for( PositionSet::const_iterator pos_iter = ps.begin(); pos_iter != ps.end(); ++pos_iter ) {
-      PositionPtr pPos = (*pos_iter);
+    const std::vector<Position::ID> ids = openIds( m_db.name() );
+    for( std::vector<Position::ID>::const_iterator id_iter = ids.begin(); id_iter != ids.end(); ++id_iter ) {
       // Sell at tomorrow's open
       //cout << "Selling on " << iter_exit->first << " at " << iter_exit->second.open << endl;
-      close(pPos->id(), iter_exit->first, Price( iter_exit->second.open ) );
+      close( *id_iter, iter_exit->first, Price( iter_exit->second.open ) );
     } // end of all open positions
   }
 }
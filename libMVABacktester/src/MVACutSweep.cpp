@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2007,2008 Alberto Giannetti
+ *
+ * This file is part of Hudson.
+ *
+ * Hudson is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Hudson is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// STL
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+// Hudson
+#include "MVACutSweep.hpp"
+#include <EOMReturnFactors.hpp>
+#include <OnlineReturnFactors.hpp>
+
+
+using namespace std;
+using namespace boost::gregorian;
+using namespace Series;
+
+
+namespace {
+
+  //! Result of a failed backtest, only cut and seed are set
+  CutResult emptyResult( const Float_t& cut, const UInt_t& seed )
+  {
+    CutResult res;
+    res.cut = cut;
+    res.seed = seed;
+    res.ok = false;
+    res.roi = res.stddev = res.skew = res.avg = res.maxdd = 0;
+    res.sharpe = res.roiEOM = res.cagr = res.gsdm = 0;
+    res.nPositions = 0;
+    return res;
+  }
+
+}
+
+
+MVACutSweep::MVACutSweep( const EODSeries& db, const IndicatorApp& app, const std::string& mva, const boost::shared_ptr< const std::vector< Float_t > >& scores,
+                          const date& begin, const date& end, double rf_rate )
+ :
+  m_db( db ),
+  m_app( app ),
+  m_mvaName( mva ),
+  m_scores( scores ),
+  m_begin( begin ),
+  m_end( end ),
+  m_rf_rate( rf_rate ),
+  m_next( 0 )
+{
+}
+
+
+void MVACutSweep::run( const std::vector< Float_t >& cuts, const std::vector< UInt_t >& seeds, const unsigned& dayshift, const MVABacktester::Type& type, unsigned nThreads )
+{
+  if( seeds.size() != cuts.size() ) {
+    std::cerr << "MVACutSweep: run - need one seed per cut value.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  m_results.assign( cuts.size(), CutResult() );
+  m_next = 0;
+
+  if( nThreads == 0 ) nThreads = std::max( std::thread::hardware_concurrency(), 1u );
+  nThreads = std::min< unsigned >( nThreads, cuts.size() );
+
+  // Every thread takes the next cut until all have been backtested
+  std::vector< std::thread > threads;
+  for( unsigned i = 1; i < nThreads; ++i )
+    threads.push_back( std::thread( &MVACutSweep::worker, this, std::cref( cuts ), std::cref( seeds ), dayshift, type ) );
+
+  worker( cuts, seeds, dayshift, type );
+
+  for( std::vector< std::thread >::iterator it = threads.begin(); it != threads.end(); ++it )
+    it->join();
+}
+
+
+void MVACutSweep::worker( const std::vector< Float_t >& cuts, const std::vector< UInt_t >& seeds, const unsigned& dayshift, const MVABacktester::Type& type )
+{
+  for( std::size_t i = m_next++; i < cuts.size(); i = m_next++ )
+    m_results[i] = backtest( cuts[i], seeds[i], dayshift, type );
+}
+
+
+CutResult MVACutSweep::backtest( const Float_t& cut, const UInt_t& seed, const unsigned& dayshift, const MVABacktester::Type& type ) const
+{
+  try {
+
+    MVABacktester backtester( m_db, m_app, m_mvaName, cut );
+    backtester.setLedger();
+    backtester.setScores( m_scores );
+    backtester.setSeed( seed );
+    backtester.setVerbose( false );
+    backtester.run( dayshift, type );
+
+    return evaluate( backtester, cut, seed );
+
+  } catch( std::exception& e ) {
+
+    cerr << "MVACutSweep: cut " << cut << " failed: " << e.what() << endl;
+  }
+
+  return emptyResult( cut, seed );
+}
+
+
+CutResult MVACutSweep::evaluate( MVABacktester& backtester, const Float_t& cut, const UInt_t& seed ) const
+{
+  CutResult res = emptyResult( cut, seed );
+
+  try {
+
+    EOMReturnFactors eomrf( backtester.positions( m_db.name() ), m_begin, m_end, m_rf_rate );
+    res.sharpe = eomrf.sharpe();
+    res.roiEOM = eomrf.roi();
+    res.cagr = eomrf.cagr();
+    res.gsdm = eomrf.gsd();
+
+    // Every trade is closed by the end of the run, the trader statistics cover all positions
+    const OnlineReturnFactors& stats = backtester.stats();
+    res.roi = stats.roi();
+    res.stddev = stats.stddev();
+    res.skew = stats.skew();
+    res.avg = stats.avg();
+    res.nPositions = stats.num();
+    res.maxdd = stats.dd() - 1;
+    res.ok = true;
+
+  } catch( std::exception& e ) {
+
+    cerr << "MVACutSweep: cut " << cut << " failed: " << e.what() << endl;
+  }
+
+  return res;
+}
+
+
+ReportTable MVACutSweep::table( void ) const
+{
+  ReportTable table( "cut_sweep" );
+  const std::size_t cut = table.column( "cut" ), seed = table.column( "seed" ), ok = table.column( "ok" ), trades = table.column( "trades" ),
+                    roi = table.column( "roi" ), stddev = table.column( "stddev" ), skew = table.column( "skew" ), avg = table.column( "avg" ),
+                    maxdd = table.column( "maxdd" ), sharpe = table.column( "sharpe" ), roiEOM = table.column( "roi_eom" ),
+                    cagr = table.column( "cagr" ), gsdm = table.column( "gsdm" );
+
+  for( std::vector< CutResult >::const_iterator it = m_results.begin(); it != m_results.end(); ++it ) {
+    const std::size_t row = table.add_row();
+    table.set( cut, row, it->cut );
+    table.set( seed, row, it->seed );
+    table.set( ok, row, it->ok ? 1 : 0 );
+    if( !it->ok ) continue;
+
+    table.set( trades, row, it->nPositions );
+    table.set( roi, row, it->roi );
+    table.set( stddev, row, it->stddev );
+    table.set( skew, row, it->skew );
+    table.set( avg, row, it->avg );
+    table.set( maxdd, row, it->maxdd );
+    table.set( sharpe, row, it->sharpe );
+    table.set( roiEOM, row, it->roiEOM );
+    table.set( cagr, row, it->cagr );
+    table.set( gsdm, row, it->gsdm );
+  }
+
+  return table;
+}
+
+
+void MVACutSweep::print( void ) const
+{
+  const std::ios_base::fmtflags flags = cout.flags();
+  const std::streamsize precision = cout.precision();
+
+  cout << setw(10) << "Cut" << setw(10) << "Trades" << setw(10) << "ROI" << setw(10) << "Sharpe"
+       << setw(10) << "MaxDD" << setw(10) << "CAGR" << setw(10) << "GSDm" << endl;
+
+  cout << fixed << setprecision(4);
+  for( std::vector< CutResult >::const_iterator it = m_results.begin(); it != m_results.end(); ++it ) {
+    cout << setw(10) << it->cut;
+    if( !it->ok ) {
+      cout << setw(10) << "FAILED" << endl;
+      continue;
+    }
+    cout << setw(10) << it->nPositions << setw(10) << it->roi << setw(10) << it->sharpe
+         << setw(10) << it->maxdd << setw(10) << it->cagr << setw(10) << it->gsdm << endl;
+  }
+
+  cout.flags( flags );
+  cout.precision( precision );
+}
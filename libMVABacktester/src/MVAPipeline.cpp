@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2007,2008 Alberto Giannetti
+ *
+ * This file is part of Hudson.
+ *
+ * Hudson is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Hudson is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// STL
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+// ROOT
+#include "TMVA/Config.h"
+
+// Hudson
+#include "MVAPipeline.hpp"
+#include "TMVAClassification.hpp"
+#include "TMVAReader.hpp"
+#include "TreeWriter.hpp"
+
+
+using namespace std;
+using namespace boost::gregorian;
+using namespace Series;
+
+
+MVAPipeline::MVAPipeline( const EODSeries& db, const IndicatorApp& app, const std::set< std::pair< std::string, std::string > >& leaves, const unsigned& dayshift )
+ :
+  m_db( db ),
+  m_app( app ),
+  m_leaves( leaves ),
+  m_dayshift( dayshift )
+{
+}
+
+
+void MVAPipeline::initialise()
+{
+  const int startIdx = m_app.getStartIdx();
+  if( startIdx >= static_cast<int>( m_db.size() ) ) {
+    std::cerr << "MVAPipeline: initialise - the series is shorter than the indicator period.\n";
+    exit(EXIT_FAILURE);
+  }
+  const std::size_t rows = m_db.size() - startIdx;
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- One column per leaf, named as in maketuple. STOCHRSIDK is derived from the D and K lines.
+  std::vector< std::string > names;
+  std::vector< std::vector< double > > columns;
+  bool hasD(false), hasK(false), hasDK(false);
+  for ( std::set< std::pair< std::string, std::string > >::const_iterator p = m_leaves.begin( ); p != m_leaves.end( ); ++p ) {
+    if( p->first == "STOCHRSIDK" ) {
+      hasDK = true;
+      continue;
+    }
+    names.push_back( p->second != "" ? p->first+"_"+p->second : p->first );
+    columns.push_back( m_app.column( p->first, p->second ) );
+    hasD = hasD || ( p->first == "STOCHRSI" && p->second == "D" );
+    hasK = hasK || ( p->first == "STOCHRSI" && p->second == "K" );
+  }
+  if( hasDK || ( hasD && hasK ) ) {
+    const std::vector< double > d = m_app.column( "STOCHRSI", "D" );
+    const std::vector< double > k = m_app.column( "STOCHRSI", "K" );
+    std::vector< double > dk( rows );
+    for( std::size_t i(0); i < rows; ++i ) dk[i] = d[i] - k[i];
+    names.push_back( "STOCHRSIDK" );
+    columns.push_back( dk );
+  }
+
+  m_features = NN::FeatureMatrix( names );
+  m_features.reserve( rows );
+  m_dates.clear();
+  m_close.clear();
+  m_change.clear();
+  m_scores.clear();
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Rows and labels: the change is the close dayshift+1 bars ahead over today's close
+  std::vector< Float_t > values( names.size() );
+  EODSeries::const_iterator iter( m_db.begin() );
+  std::advance( iter, startIdx );
+  for( std::size_t i(0); iter != m_db.end(); ++iter, ++i ) {
+
+    for( std::size_t j(0); j < columns.size(); ++j ) values[j] = static_cast<Float_t>( columns[j][i] );
+    m_features.addRow( values );
+    m_dates.push_back( iter->first );
+    m_close.push_back( iter->second.close );
+
+    double change = std::numeric_limits<double>::quiet_NaN();
+    EODSeries::const_iterator shifted = m_db.after( iter->first, m_dayshift + 1 );
+    if( shifted != m_db.end() ) {
+      change = std::fabs( shifted->second.close ) / (double) iter->second.close;
+    }
+    m_change.push_back( change );
+  }
+}
+
+
+bool MVAPipeline::labels( const std::size_t& row, Float_t& nsig, Float_t& nbkg, Float_t& nsig_S_sw, Float_t& nbkg_B_sw ) const
+{
+  const double change = m_change[row];
+  if( change < 1 ) {
+    const double invert = 1. + ( 1. - change );
+    nsig = 0;
+    nbkg = static_cast<Float_t>( invert );
+    nbkg_B_sw = static_cast<Float_t>( invert );
+    nsig_S_sw = static_cast<Float_t>( -1. * ( 1. - change ) );
+    return true;
+  } else if( change > 1 ) {
+    nsig = static_cast<Float_t>( change );
+    nbkg = 0;
+    nsig_S_sw = static_cast<Float_t>( change );
+    nbkg_B_sw = static_cast<Float_t>( 1. - change );
+    return true;
+  }
+  // unchanged or not labelled (NaN)
+  return false;
+}
+
+
+bool MVAPipeline::train( const std::vector< std::string >& methods, const std::vector< std::string >& inputvars, const date_period& period,
+                         const std::string& outputFile, const std::string& weightsDir, const std::map< std::string, std::string >& options )
+{
+  if( m_features.empty() ) {
+    std::cerr << "MVAPipeline: train - initialise has not been called.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Same selection and weights as mva uses on the maketuple output
+  const NN::FeatureMatrix inputs = m_features.select( inputvars );
+  NN::FeatureMatrix signal( inputvars ), background( inputvars );
+  std::vector< Double_t > sWeights, bWeights;
+  std::vector< Float_t > values( inputvars.size() );
+  Float_t nsig(0.), nbkg(0.), nsig_S_sw(0.), nbkg_B_sw(0.);
+
+  for( std::size_t i(0); i < inputs.rows(); ++i ) {
+
+    if( !period.contains( m_dates[i] ) || !labels( i, nsig, nbkg, nsig_S_sw, nbkg_B_sw ) ) continue;
+
+    values.assign( inputs.row(i), inputs.row(i) + inputs.columns() );
+    if( nsig > 1.01 ) {
+      signal.addRow( values );
+      sWeights.push_back( nbkg_B_sw );
+    } else if( nbkg > 1.01 ) {
+      background.addRow( values );
+      bWeights.push_back( nsig_S_sw );
+    }
+  }
+
+  if( signal.empty() || background.empty() ) {
+    std::cerr << "MVAPipeline: train - no signal or background bars in " << period << ".\n";
+    return false;
+  }
+  std::cout << "MVAPipeline: training on " << signal.rows() << " signal and " << background.rows() << " background bars in " << period << std::endl;
+
+  ( TMVA::gConfig().GetIONames() ).fWeightFileDir = weightsDir.c_str();
+
+  NN::TMVAClassification classifier( methods, inputvars, outputFile );
+  for( std::map< std::string, std::string >::const_iterator it = options.begin(); it != options.end(); ++it ) {
+    classifier.setMethodOption( it->first, it->second );
+  }
+  classifier.setSignalAndBackground( signal, background, sWeights, bWeights );
+  classifier.prepareTestAndTrain();
+  classifier.bookMethods();
+
+  return classifier.train();
+}
+
+
+boost::shared_ptr< const std::vector< Float_t > > MVAPipeline::score( const std::string& method, const std::vector< std::string >& inputvars, const std::string& weightsDir )
+{
+  if( m_features.empty() ) {
+    std::cerr << "MVAPipeline: score - initialise has not been called.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  const std::vector< std::string > methods( 1, method );
+  NN::TMVAReader reader( methods, inputvars, "", weightsDir );
+
+  boost::shared_ptr< const std::vector< Float_t > > scores( new std::vector< Float_t >( reader.getMvaValues( method, m_features ) ) );
+  m_scores[method] = scores;
+  return scores;
+}
+
+
+void MVAPipeline::writeTuple( const std::string& filename, const std::string& treepath ) const
+{
+  NN::TreeWriter treeWriter( filename, treepath );
+  treeWriter.add( "Day" );
+  treeWriter.add( "Month" );
+  treeWriter.add( "Year" );
+  treeWriter.add( "close" );
+  treeWriter.add( "nsig" );
+  treeWriter.add( "nbkg" );
+  treeWriter.add( "nsig_S_sw" );
+  treeWriter.add( "nbkg_B_sw" );
+  const std::vector< std::string >& names = m_features.names();
+  for( std::size_t j(0); j < names.size(); ++j ) treeWriter.add( names[j] );
+  for( std::map< std::string, boost::shared_ptr< const std::vector< Float_t > > >::const_iterator it = m_scores.begin(); it != m_scores.end(); ++it ) {
+    treeWriter.add( "nn_" + it->first );
+  }
+
+  // only the labelled bars, as maketuple does
+  Float_t nsig(0.), nbkg(0.), nsig_S_sw(0.), nbkg_B_sw(0.);
+  for( std::size_t i(0); i < m_features.rows(); ++i ) {
+
+    if( !labels( i, nsig, nbkg, nsig_S_sw, nbkg_B_sw ) ) continue;
+
+    treeWriter.column( "Day", static_cast<Float_t>( m_dates[i].day() ) );
+    treeWriter.column( "Month", static_cast<Float_t>( m_dates[i].month() ) );
+    treeWriter.column( "Year", static_cast<Float_t>( m_dates[i].year() ) );
+    treeWriter.column( "close", static_cast<Float_t>( m_close[i] ) );
+    treeWriter.column( "nsig", nsig );
+    treeWriter.column( "nbkg", nbkg );
+    treeWriter.column( "nsig_S_sw", nsig_S_sw );
+    treeWriter.column( "nbkg_B_sw", nbkg_B_sw );
+    for( std::size_t j(0); j < names.size(); ++j ) treeWriter.column( names[j], m_features( i, j ) );
+    for( std::map< std::string, boost::shared_ptr< const std::vector< Float_t > > >::const_iterator it = m_scores.begin(); it != m_scores.end(); ++it ) {
+      treeWriter.column( "nn_" + it->first, (*it->second)[i] );
+    }
+    treeWriter.write();
+  }
+}
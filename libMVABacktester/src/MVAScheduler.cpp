@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2007,2008 Alberto Giannetti
+ *
+ * This file is part of Hudson.
+ *
+ * Hudson is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Hudson is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// STL
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+// Hudson
+#include "MVAScheduler.hpp"
+#include <EODDB.hpp>
+#include <OnlineReturnFactors.hpp>
+
+
+using namespace std;
+using namespace boost::gregorian;
+using namespace Series;
+
+
+MVAScheduler::MVAScheduler( const date& begin, const date& end, double rf_rate )
+ :
+  m_begin( begin ),
+  m_end( end ),
+  m_rf_rate( rf_rate )
+{
+}
+
+
+std::size_t MVAScheduler::add( const MVAJob& job )
+{
+  if( job.app == 0 || !job.scores ) {
+    std::cerr << "MVAScheduler: add - job " << job.symbol << " needs indicators and scores.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  m_jobs.push_back( job );
+  return m_jobs.size() - 1;
+}
+
+
+void MVAScheduler::run( unsigned nThreads )
+{
+  m_results.assign( m_jobs.size(), MVAJobResult() );
+  m_factors.assign( m_jobs.size(), boost::shared_ptr< EOMReturnFactors >() );
+  if( m_jobs.empty() ) return;
+
+  if( nThreads == 0 ) nThreads = std::max( std::thread::hardware_concurrency(), 1u );
+  nThreads = std::min< unsigned >( nThreads, m_jobs.size() );
+
+  m_queues.assign( nThreads, std::deque< std::size_t >() );
+  m_locks.reset( new std::mutex[nThreads] );
+  for( std::size_t i = 0; i < m_jobs.size(); ++i )
+    m_queues[i % nThreads].push_back( i );
+
+  std::vector< std::thread > threads;
+  for( unsigned i = 1; i < nThreads; ++i )
+    threads.push_back( std::thread( &MVAScheduler::worker, this, i ) );
+
+  worker( 0 );
+
+  for( std::vector< std::thread >::iterator it = threads.begin(); it != threads.end(); ++it )
+    it->join();
+}
+
+
+void MVAScheduler::worker( const unsigned& self )
+{
+  std::size_t job;
+  while( next( self, job ) )
+    backtest( job );
+}
+
+
+bool MVAScheduler::next( const unsigned& self, std::size_t& job )
+{
+  const unsigned nThreads = m_queues.size();
+
+  {
+    std::lock_guard< std::mutex > lock( m_locks[self] );
+    if( !m_queues[self].empty() ) {
+      job = m_queues[self].back();
+      m_queues[self].pop_back();
+      return true;
+    }
+  }
+
+  // No jobs are added while running, so once every queue is empty the thread is done
+  for( unsigned k = 1; k < nThreads; ++k ) {
+    const unsigned victim = ( self + k ) % nThreads;
+    std::lock_guard< std::mutex > lock( m_locks[victim] );
+    if( !m_queues[victim].empty() ) {
+      job = m_queues[victim].front();
+      m_queues[victim].pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+void MVAScheduler::backtest( const std::size_t& job )
+{
+  const MVAJob& spec = m_jobs[job];
+
+  MVAJobResult& res = m_results[job];
+  res.symbol = spec.symbol;
+  res.mva = spec.mva;
+  res.cut = spec.cut;
+  res.ok = false;
+  res.nPositions = 0;
+  res.roi = res.sharpe = res.roiEOM = res.cagr = res.gsdm = 0;
+
+  try {
+
+    const EODSeries& db = EODDB::instance().get( spec.symbol );
+
+    MVABacktester backtester( db, *spec.app, spec.mva, spec.cut );
+    backtester.setLedger();
+    backtester.setScores( spec.scores );
+    backtester.setSeed( spec.seed );
+    backtester.setVerbose( false );
+    backtester.setPeriod( date_period( m_begin, m_end ) );
+    backtester.run( spec.dayshift, spec.type );
+
+    boost::shared_ptr< EOMReturnFactors > eomrf( new EOMReturnFactors( backtester.positions( spec.symbol ), m_begin, m_end, m_rf_rate ) );
+    res.sharpe = eomrf->sharpe();
+    res.roiEOM = eomrf->roi();
+    res.cagr = eomrf->cagr();
+    res.gsdm = eomrf->gsd();
+
+    res.roi = backtester.stats().roi();
+    res.nPositions = backtester.stats().num();
+
+    m_factors[job] = eomrf;
+    res.ok = true;
+
+  } catch( std::exception& e ) {
+
+    cerr << "MVAScheduler: job " << spec.symbol << " " << spec.mva << " failed: " << e.what() << endl;
+  }
+}
+
+
+PortfolioReturns MVAScheduler::portfolio( void ) const throw(PortfolioReturnsException)
+{
+  PortfolioReturns pr;
+  for( std::size_t i = 0; i < m_factors.size(); ++i )
+    if( m_factors[i] )
+      pr.add( m_factors[i].get(), m_jobs[i].weight );
+
+  return pr;
+}
+
+
+void MVAScheduler::print( void ) const
+{
+  const std::ios_base::fmtflags flags = cout.flags();
+  const std::streamsize precision = cout.precision();
+
+  cout << setw(10) << "Symbol" << setw(10) << "MVA" << setw(10) << "Cut" << setw(10) << "Trades" << setw(10) << "ROI"
+       << setw(10) << "Sharpe" << setw(10) << "CAGR" << setw(10) << "GSDm" << endl;
+
+  cout << fixed << setprecision(4);
+  for( std::vector< MVAJobResult >::const_iterator it = m_results.begin(); it != m_results.end(); ++it ) {
+    cout << setw(10) << it->symbol << setw(10) << it->mva << setw(10) << it->cut;
+    if( !it->ok ) {
+      cout << setw(10) << "FAILED" << endl;
+      continue;
+    }
+    cout << setw(10) << it->nPositions << setw(10) << it->roi << setw(10) << it->sharpe
+         << setw(10) << it->cagr << setw(10) << it->gsdm << endl;
+  }
+
+  try {
+    const PortfolioReturns pr = portfolio();
+    if( pr.series() ) {
+      cout << setw(30) << "Portfolio" << setw(10) << pr.series() << setw(10) << pr.roi() << setw(10) << pr.sharpe()
+           << setw(10) << pr.cagr() << setw(10) << pr.gsd() << endl;
+    }
+  } catch( std::exception& e ) {
+    cerr << "MVAScheduler: " << e.what() << endl;
+  }
+
+  cout.flags( flags );
+  cout.precision( precision );
+}
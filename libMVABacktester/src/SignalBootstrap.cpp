@@ -0,0 +1,184 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+// Hudson
+#include "SignalBootstrap.hpp"
+#include "SignalScan.hpp"
+
+
+using namespace std;
+
+namespace
+{
+  // Paths handed to a thread at a time
+  const std::size_t chunk = 64;
+}
+
+
+SignalBootstrap::SignalBootstrap( const std::vector< Float_t >& scores, const std::vector< double >& factors )
+ :
+  m_scores( scores ),
+  m_factors( factors ),
+  m_next( 0 )
+{
+  if( m_scores.size() != m_factors.size() ) {
+    std::cerr << "SignalBootstrap: " << m_scores.size() << " scores and " << m_factors.size() << " trade factors.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  for( std::size_t i = 0; i < m_factors.size(); ++i )
+    if( !std::isnan( m_factors[i] ) ) m_tradable.push_back( i );
+}
+
+
+BootstrapResult SignalBootstrap::run( const Float_t& cut, const Mode& mode, const unsigned& nPaths, const unsigned& blockLength,
+                                      const double& confidence, const uint64_t& seed, unsigned nThreads )
+{
+  const ScanResult observed = SignalScan( m_scores, m_factors ).evaluate( cut );
+
+  BootstrapResult res;
+  res.cut = cut;
+  res.nPositions = observed.nPositions;
+  res.roi = observed.roi;
+  res.maxdd = observed.maxdd;
+  res.roiCI.mean = res.roiCI.lower = res.roiCI.upper = 0;
+  res.maxddCI = res.roiCI;
+  // Block paths resample the strategy's own trades and center on its ROI, they test nothing
+  res.pValue = ( mode == RandomEntry ) ? 1 : std::numeric_limits<double>::quiet_NaN();
+
+  // Strategy trades in time order, the same selection as SignalScan
+  std::vector< double > selected;
+  for( std::vector< std::size_t >::const_iterator it = m_tradable.begin(); it != m_tradable.end(); ++it )
+    if( m_scores[*it] >= cut ) selected.push_back( m_factors[*it] );
+
+  m_roi.assign( nPaths, 0. );
+  m_maxdd.assign( nPaths, 0. );
+  if( selected.empty() || nPaths == 0 ) return res;
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Every thread takes the next chunk of paths until all have been drawn
+  m_next = 0;
+  if( nThreads == 0 ) nThreads = std::max( std::thread::hardware_concurrency(), 1u );
+  nThreads = std::min< unsigned >( nThreads, ( nPaths + chunk - 1 ) / chunk );
+
+  std::vector< std::thread > threads;
+  for( unsigned i = 1; i < nThreads; ++i )
+    threads.push_back( std::thread( &SignalBootstrap::worker, this, std::cref( selected ), mode, std::max( blockLength, 1u ), seed ) );
+
+  worker( selected, mode, std::max( blockLength, 1u ), seed );
+
+  for( std::vector< std::thread >::iterator it = threads.begin(); it != threads.end(); ++it )
+    it->join();
+
+  res.roiCI = interval( m_roi, confidence );
+  res.maxddCI = interval( m_maxdd, confidence );
+
+  if( mode == RandomEntry ) {
+    std::size_t better = 0;
+    for( std::size_t i = 0; i < m_roi.size(); ++i )
+      if( m_roi[i] >= res.roi ) ++better;
+    res.pValue = double( better ) / m_roi.size();
+  }
+
+  return res;
+}
+
+
+void SignalBootstrap::worker( const std::vector< double >& selected, const Mode& mode, const unsigned& blockLength, const uint64_t& seed )
+{
+  const std::size_t nPaths = m_roi.size();
+  const std::size_t nTrades = selected.size();
+  const std::size_t nTradable = m_tradable.size();
+
+  for( std::size_t first = m_next.fetch_add( chunk ); first < nPaths; first = m_next.fetch_add( chunk ) ) {
+
+    const std::size_t last = std::min( first + chunk, nPaths );
+    for( std::size_t path = first; path < last; ++path ) {
+
+      CounterRNG rng( seed, path );
+      double product = 1, runMin = 1, worst = 1;
+
+      if( mode == BlockBootstrap ) {
+
+        // Blocks start anywhere in the trade sequence and wrap around its end
+        std::size_t drawn = 0;
+        while( drawn < nTrades ) {
+          std::size_t k = rng.below( nTrades );
+          for( unsigned b = 0; b < blockLength && drawn < nTrades; ++b, ++drawn ) {
+            const double f = selected[k];
+            product *= f;
+            runMin = f * std::min( runMin, 1.0 );
+            worst = std::min( worst, runMin );
+            if( ++k == nTrades ) k = 0;
+          }
+        }
+
+      } else {
+
+        // Selection sampling picks nTrades distinct bars in time order in one pass
+        std::size_t needed = nTrades;
+        for( std::size_t i = 0; i < nTradable && needed > 0; ++i ) {
+          if( rng.uniform() * ( nTradable - i ) >= needed ) continue;
+          const double f = m_factors[ m_tradable[i] ];
+          product *= f;
+          runMin = f * std::min( runMin, 1.0 );
+          worst = std::min( worst, runMin );
+          --needed;
+        }
+      }
+
+      m_roi[path] = product - 1;
+      m_maxdd[path] = worst - 1;
+    }
+  }
+}
+
+
+BootstrapInterval SignalBootstrap::interval( std::vector< double > values, const double& confidence )
+{
+  BootstrapInterval ci;
+  ci.mean = ci.lower = ci.upper = 0;
+  if( values.empty() ) return ci;
+
+  double sum = 0;
+  for( std::size_t i = 0; i < values.size(); ++i )
+    sum += values[i];
+  ci.mean = sum / values.size();
+
+  // Percentile interval
+  const double alpha = 0.5 * ( 1. - confidence );
+  const std::size_t lo = std::min< std::size_t >( values.size() - 1, static_cast< std::size_t >( alpha * values.size() ) );
+  const std::size_t hi = std::min< std::size_t >( values.size() - 1, static_cast< std::size_t >( ( 1. - alpha ) * values.size() ) );
+
+  std::nth_element( values.begin(), values.begin() + lo, values.end() );
+  ci.lower = values[lo];
+  std::nth_element( values.begin(), values.begin() + hi, values.end() );
+  ci.upper = values[hi];
+
+  return ci;
+}
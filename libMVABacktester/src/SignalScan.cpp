@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2007,2008 Alberto Giannetti
+ *
+ * This file is part of Hudson.
+ *
+ * Hudson is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Hudson is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// STL
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+// GSL
+#include <gsl/gsl_statistics_double.h>
+
+// Hudson
+#include "SignalScan.hpp"
+
+
+using namespace std;
+
+
+SignalScan::SignalScan( const std::vector< Float_t >& scores, const std::vector< double >& factors )
+ :
+  m_scores( scores ),
+  m_factors( factors )
+{
+  if( m_scores.size() != m_factors.size() ) {
+    std::cerr << "SignalScan: " << m_scores.size() << " scores and " << m_factors.size() << " trade factors.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  // Bars that can't trade never pass a cut
+  for( std::size_t i = 0; i < m_scores.size(); ++i )
+    if( std::isnan( m_factors[i] ) ) m_scores[i] = std::numeric_limits<Float_t>::quiet_NaN();
+}
+
+
+std::vector< ScanResult > SignalScan::run( const std::vector< Float_t >& cuts ) const
+{
+  std::vector< ScanResult > results;
+  results.reserve( cuts.size() );
+  for( std::vector< Float_t >::const_iterator it = cuts.begin(); it != cuts.end(); ++it )
+    results.push_back( evaluate( *it ) );
+
+  return results;
+}
+
+
+ScanResult SignalScan::evaluate( const Float_t& cut ) const
+{
+  ScanResult res;
+  res.cut = cut;
+  res.nPositions = 0;
+  res.roi = res.avg = res.stddev = res.skew = res.maxdd = 0;
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Selected factors in trade order. NaN scores fail the comparison.
+  std::vector< double > selected;
+  selected.reserve( m_scores.size() );
+  double product = 1, sum = 0;
+  double runMin = 1, worst = 1; // lowest compounded factor of a run ending at the current trade
+  const std::size_t n = m_scores.size();
+  for( std::size_t i = 0; i < n; ++i ) {
+    if( !( m_scores[i] >= cut ) ) continue;
+    const double f = m_factors[i];
+    selected.push_back( f );
+    product *= f;
+    sum += f;
+    runMin = f * std::min( runMin, 1.0 );
+    worst = std::min( worst, runMin );
+  }
+
+  if( selected.empty() )
+    return res;
+
+  const double mean = sum / selected.size();
+  double ss = 0;
+  for( std::size_t i = 0; i < selected.size(); ++i )
+    ss += ( selected[i] - mean ) * ( selected[i] - mean );
+
+  res.nPositions = (int)selected.size();
+  res.roi = product - 1;
+  res.avg = mean - 1;
+  // A single trade has no spread, as OnlineReturnFactors in the sweep
+  if( selected.size() >= 2 ) {
+    res.stddev = ::sqrt( ss / ( selected.size() - 1 ) );
+    res.skew = gsl_stats_skew_m_sd( &selected[0], 1, selected.size(), mean, res.stddev );
+  }
+  res.maxdd = worst - 1;
+
+  return res;
+}
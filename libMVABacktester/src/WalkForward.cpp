@@ -0,0 +1,247 @@
+/*
+* Copyright (C) 2007, Alberto Giannetti
+*
+* This file is part of Hudson.
+*
+* Hudson is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Hudson is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Hudson.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+// POSIX
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ROOT
+#include "TSystem.h"
+
+// Hudson
+#include "WalkForward.hpp"
+
+
+using namespace std;
+using namespace boost::gregorian;
+using namespace Series;
+
+
+WalkForward::WalkForward( const EODSeries& db, const IndicatorApp& app, MVAPipeline& pipeline, const std::string& jobDir )
+ :
+  m_db( db ),
+  m_app( app ),
+  m_pipeline( pipeline ),
+  m_jobDir( jobDir )
+{
+}
+
+
+void WalkForward::setFolds( const date& begin, const date& end, const unsigned& trainMonths, const unsigned& testMonths, const bool& anchored )
+{
+  if( trainMonths == 0 || testMonths == 0 ) {
+    std::cerr << "WalkForward: setFolds - train and test windows must be at least one month.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  m_folds.clear();
+  const unsigned dayshift = m_pipeline.dayshift();
+
+  for( date test_begin = begin + months( trainMonths ); test_begin < end; test_begin = test_begin + months( testMonths ) ) {
+
+    const date train_begin = anchored ? begin : test_begin - months( trainMonths );
+    const date test_end = std::min( test_begin + months( testMonths ), end );
+
+    // Purge the bars whose labels reach into the test window
+    const EODSeries::const_iterator last_train = m_db.before( test_begin, dayshift + 1 );
+    const date train_end = last_train != m_db.end() ? last_train->first : train_begin;
+
+    std::ostringstream dir;
+    dir << m_jobDir << "/fold_" << m_folds.size();
+
+    WalkForwardFold fold = { date_period( train_begin, std::max( train_begin, train_end ) ), date_period( test_begin, test_end ), dir.str(), false, 0, 0. };
+    m_folds.push_back( fold );
+  }
+}
+
+
+bool WalkForward::train( const std::vector< std::string >& methods, const std::vector< std::string >& inputvars, const unsigned& nWorkers,
+                         const std::map< std::string, std::string >& options )
+{
+  if( m_folds.empty() ) {
+    std::cerr << "WalkForward: train - no folds, call setFolds first.\n";
+    return false;
+  }
+
+  gSystem->mkdir( m_jobDir.c_str(), kTRUE );
+
+  const unsigned workers = std::max( nWorkers, 1u );
+  std::map< pid_t, std::size_t > running;
+  std::size_t next(0);
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Keep up to nWorkers forked trainings going until every fold has finished
+  while( next < m_folds.size() || !running.empty() ) {
+
+    while( next < m_folds.size() && running.size() < workers ) {
+
+      WalkForwardFold& fold = m_folds[next];
+      gSystem->mkdir( ( fold.dir + "/weights" ).c_str(), kTRUE );
+
+      std::cout.flush(); std::cerr.flush(); fflush( 0 );
+      const pid_t pid = fork();
+
+      if( pid == 0 ) {
+
+        const bool ok = m_pipeline.train( methods, inputvars, fold.train, fold.dir + "/TMVA.root", fold.dir + "/weights", options );
+        std::cout.flush(); std::cerr.flush(); fflush( 0 );
+        _exit( ok ? EXIT_SUCCESS : EXIT_FAILURE );
+
+      } else if( pid < 0 ) {
+
+        std::cerr << "WalkForward: could not fork a worker, training fold " << next << " in this process.\n";
+        fold.ok = m_pipeline.train( methods, inputvars, fold.train, fold.dir + "/TMVA.root", fold.dir + "/weights", options );
+        ++next;
+
+      } else {
+
+        std::cout << "WalkForward: training fold " << next << " on " << fold.train << " in process " << pid << std::endl;
+        running[pid] = next++;
+      }
+    }
+
+    if( running.empty() ) continue;
+
+    int wstatus(0);
+    const pid_t pid = waitpid( -1, &wstatus, 0 );
+    if( pid < 0 ) {
+      std::cerr << "WalkForward: lost track of " << running.size() << " training workers.\n";
+      break;
+    }
+
+    std::map< pid_t, std::size_t >::iterator it = running.find( pid );
+    if( it == running.end() ) continue;
+
+    m_folds[it->second].ok = WIFEXITED( wstatus ) && WEXITSTATUS( wstatus ) == EXIT_SUCCESS;
+    if( !m_folds[it->second].ok )
+      std::cerr << "WalkForward: training fold " << it->second << " failed.\n";
+    running.erase( it );
+  }
+
+  bool ok(true);
+  for( std::vector< WalkForwardFold >::const_iterator it = m_folds.begin(); it != m_folds.end(); ++it )
+    ok = ok && it->ok;
+
+  return ok;
+}
+
+
+boost::shared_ptr< const std::vector< Float_t > > WalkForward::score( const std::string& method, const std::vector< std::string >& inputvars )
+{
+  const std::vector< date >& dates = m_pipeline.dates();
+  std::vector< Float_t >* stitched = new std::vector< Float_t >( dates.size(), std::numeric_limits< Float_t >::quiet_NaN() );
+  m_scores.reset( stitched );
+
+  for( std::vector< WalkForwardFold >::const_iterator it = m_folds.begin(); it != m_folds.end(); ++it ) {
+
+    if( !it->ok ) continue;
+
+    const boost::shared_ptr< const std::vector< Float_t > > scores = m_pipeline.score( method, inputvars, it->dir + "/weights" );
+
+    // Test windows don't overlap, each bar is taken from exactly one fold
+    const std::size_t first = std::lower_bound( dates.begin(), dates.end(), it->test.begin() ) - dates.begin();
+    for( std::size_t i = first; i < dates.size() && it->test.contains( dates[i] ); ++i )
+      (*stitched)[i] = (*scores)[i];
+  }
+
+  return m_scores;
+}
+
+
+void WalkForward::backtest( const std::string& method, const Float_t& cut, const MVABacktester::Type& type, const UInt_t& seed )
+{
+  if( !m_scores ) {
+    std::cerr << "WalkForward: backtest - call score first.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  MVABacktester backtester( m_db, m_app, method, cut );
+  backtester.setLedger();
+  backtester.setScores( m_scores );
+  backtester.setSeed( seed );
+  backtester.setVerbose( false );
+  backtester.setPeriod( period() );
+  backtester.run( m_pipeline.dayshift(), type );
+
+  m_positions = backtester.positions();
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Attribute every position to the fold whose test window it was opened in
+  for( std::vector< WalkForwardFold >::iterator it = m_folds.begin(); it != m_folds.end(); ++it ) {
+    it->nPositions = 0;
+    it->roi = 1.;
+  }
+
+  for( PositionSet::const_iterator pos = m_positions.begin(); pos != m_positions.end(); ++pos ) {
+    const date opened = (*pos)->first_exec()->dt();
+    for( std::vector< WalkForwardFold >::iterator it = m_folds.begin(); it != m_folds.end(); ++it ) {
+      if( !it->test.contains( opened ) ) continue;
+      ++it->nPositions;
+      it->roi *= (*pos)->factor();
+      break;
+    }
+  }
+
+  for( std::vector< WalkForwardFold >::iterator it = m_folds.begin(); it != m_folds.end(); ++it )
+    it->roi -= 1.;
+}
+
+
+date_period WalkForward::period() const
+{
+  if( m_folds.empty() ) return date_period( date(), date() );
+
+  return date_period( m_folds.front().test.begin(), m_folds.back().test.end() );
+}
+
+
+void WalkForward::print() const
+{
+  const std::ios_base::fmtflags flags = cout.flags();
+  const std::streamsize precision = cout.precision();
+
+  cout << setw(6) << "Fold" << setw(26) << "Train" << setw(26) << "Test" << setw(10) << "Trades" << setw(10) << "ROI" << endl;
+
+  cout << fixed << setprecision(4);
+  for( std::size_t i = 0; i < m_folds.size(); ++i ) {
+    const WalkForwardFold& fold = m_folds[i];
+    cout << setw(6) << i << setw(13) << fold.train.begin() << setw(13) << fold.train.end()
+         << setw(13) << fold.test.begin() << setw(13) << fold.test.end();
+    if( !fold.ok ) {
+      cout << setw(10) << "FAILED" << endl;
+      continue;
+    }
+    cout << setw(10) << fold.nPositions << setw(10) << fold.roi << endl;
+  }
+
+  cout.flags( flags );
+  cout.precision( precision );
+}
@@ -0,0 +1,89 @@
+#ifndef BDTBatchEvaluator_HPP
+#define BDTBatchEvaluator_HPP 1
+
+// STL include
+#include <string>
+#include <vector>
+#include <exception>
+
+// ROOT include
+#include "Rtypes.h"
+#include "TMVA/MethodBDT.h"
+#include "TMVA/DecisionTree.h"
+#include "TMVA/DecisionTreeNode.h"
+
+namespace NN {
+
+  class BDTBatchEvaluatorException: public std::exception
+  {
+    public:
+      BDTBatchEvaluatorException(const std::string& msg):
+        _Str("BDTBatchEvaluatorException: ") {
+        _Str += msg;
+      }
+
+      virtual ~BDTBatchEvaluatorException(void) throw() { }
+      virtual const char *what() const throw() { return _Str.c_str(); }
+
+    private:
+      std::string _Str;
+  };
+
+  /** @class BDTBatchEvaluator BDTBatchEvaluator.hpp
+  *
+  *  Scores blocks of events through a booked TMVA::MethodBDT forest.
+  *
+  *  The forest is flattened into contiguous node arrays where every leaf
+  *  loops back onto itself, so each row of a block takes exactly depth(tree)
+  *  predicated steps through a tree and no data dependent branch is taken.
+  *  Rows are transposed into per-variable lanes of m_blockSize events so the
+  *  inner loop runs over independent rows and can be vectorised.
+  *
+  *  Leaf values are taken from DecisionTree::CheckEvent and the input
+  *  variable transformation from the method's own TransformationHandler,
+  *  so the response is the one TMVA::Reader::EvaluateMVA returns.
+  */
+
+  class BDTBatchEvaluator {
+
+    public:
+
+      BDTBatchEvaluator( TMVA::MethodBDT* method, const std::string& weightfile ) throw( BDTBatchEvaluatorException );
+
+      // Score nEvents rows stored contiguously with nVariables() values per row,
+      // in the order the variables were given to the classification.
+      void evaluate( const Float_t* events, const std::size_t& nEvents, Float_t* mva ) const;
+      std::vector< Float_t > evaluate( const std::vector< std::vector< Float_t > >& events ) const;
+
+      UInt_t nVariables() const { return m_nVars; }
+      std::size_t nTrees() const { return m_treeRoot.size(); }
+
+    private:
+
+      void readOptions( const std::string& weightfile ) throw( BDTBatchEvaluatorException );
+      UInt_t flatten( const TMVA::DecisionTree* tree, const TMVA::DecisionTreeNode* node, std::vector< Float_t >& lower, std::vector< Float_t >& upper, UInt_t& depth, const UInt_t& level ) throw( BDTBatchEvaluatorException );
+
+      static const std::size_t m_blockSize = 64;
+
+      TMVA::MethodBDT* m_method;
+      UInt_t m_nVars;
+      bool m_gradBoost;
+      bool m_useYesNoLeaf;
+      Double_t m_norm;
+
+      // one entry per tree
+      std::vector< UInt_t > m_treeRoot;
+      std::vector< UInt_t > m_treeDepth;
+      std::vector< Double_t > m_treeWeight;
+
+      // one entry per node, children stored as [left, right] pairs
+      std::vector< UInt_t > m_selector;
+      std::vector< Float_t > m_cutValue;
+      std::vector< UChar_t > m_cutType;
+      std::vector< UInt_t > m_children;
+      std::vector< Double_t > m_leafValue;
+  };
+
+}
+
+#endif // BDTBatchEvaluator_HPP
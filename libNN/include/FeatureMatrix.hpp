@@ -0,0 +1,56 @@
+#ifndef FeatureMatrix_HPP
+#define FeatureMatrix_HPP 1
+
+// STL include
+#include <string>
+#include <vector>
+
+// ROOT include
+#include "Rtypes.h"
+
+namespace NN {
+
+  /** @class FeatureMatrix FeatureMatrix.hpp
+  *
+  *  Named columns of floating point features stored row after row in one
+  *  contiguous block, the in-memory counterpart of a flat TTree. Rows can be
+  *  handed to TMVAClassification for training and to TMVAReader for scoring
+  *  without going through a ROOT file.
+  */
+
+  class FeatureMatrix {
+
+    public:
+
+      FeatureMatrix() { }
+      explicit FeatureMatrix( const std::vector< std::string >& columns );
+
+      void reserve( const std::size_t& rows ) { m_data.reserve( rows * m_names.size() ); }
+      void addRow( const std::vector< Float_t >& values );
+
+      std::size_t rows() const { return m_names.empty() ? 0 : m_data.size() / m_names.size(); }
+      std::size_t columns() const { return m_names.size(); }
+      bool empty() const { return m_data.empty(); }
+
+      const std::vector< std::string >& names() const { return m_names; }
+      // Position of the named column, -1 if it does not exist.
+      int index( const std::string& column ) const;
+
+      const Float_t* row( const std::size_t& i ) const { return &m_data[ i * m_names.size() ]; }
+      Float_t& operator()( const std::size_t& i, const std::size_t& j ) { return m_data[ i * m_names.size() + j ]; }
+      const Float_t& operator()( const std::size_t& i, const std::size_t& j ) const { return m_data[ i * m_names.size() + j ]; }
+
+      // Copy of the given columns, in the given order.
+      FeatureMatrix select( const std::vector< std::string >& columns ) const;
+      // Copy of the rows [first, last).
+      FeatureMatrix slice( const std::size_t& first, const std::size_t& last ) const;
+
+    private:
+
+      std::vector< std::string > m_names;
+      std::vector< Float_t > m_data;
+  };
+
+}
+
+#endif // FeatureMatrix_HPP
@@ -24,9 +24,11 @@
 #include "TObjString.h"
 #include "TSystem.h"
 #include "TROOT.h"
+#include "TRandom3.h"
 
 // local include
 #include "DefinedMVAs.hpp"
+#include "FeatureMatrix.hpp"
 
 namespace NN {
 
@@ -57,6 +59,11 @@ namespace NN {
       void setOptions( const std::string& mvaMethod, const std::string& option ) ;
 
       void setSignalAndBackgroundTrees( TTree* signal, TTree* background, const Double_t& signalWeight = 1.0, const Double_t& backgroundWeight = 1.0 );
+      // In-memory datasets, variables are looked up by column name and the weights default to one.
+      void setSignalAndBackground( const FeatureMatrix& signal, const FeatureMatrix& background, const std::vector< Double_t >& signalWeights = std::vector< Double_t >(), const std::vector< Double_t >& backgroundWeights = std::vector< Double_t >() );
+      // One pass over a flat tree. Cuts of the form "branch>value" are compiled, anything else
+      // is evaluated as a formula. The weights are read from the named branches if given.
+      void setSignalAndBackground( TTree* tree, const std::string& signalCut, const std::string& backgroundCut, const std::string& sWeight = "", const std::string& bWeight = "" );
       void setMethodOption( const std::string& method, const std::string& option = "" );
       void setBackgroundWeightExpression( const std::string& weight = "nsig_S_sw" );
       void setSignalWeightExpression( const std::string& weight = "nbkg_B_sw" );
@@ -65,13 +72,19 @@ namespace NN {
 
       void basicSetup( TTree* signal, TTree* background, const std::string& sWeight = "", const std::string& bWeight = "", const Double_t signalWeight = 1.0, const Double_t& backgroundWeight = 1.0 );
       bool train( const bool& optimise = false ) const;
+      // Write the test sample performance of every booked method, one line each.
+      void writeSummary( const std::string& filename ) const;
 
     private:
       bool getType( const std::string& name, TMVA::Types::EMVA& type ) const ;
+      void addEvent( const bool& signal, const std::vector< Double_t >& event, const Double_t& weight );
       void summary() const;
  
+      TFile *m_outputFile;
       TMVA::Factory *m_tmvaFactory;
       bool m_variablesset, m_prepareTestAndTrain, m_methodset, m_sigandbackset;
+      std::vector< std::string > m_variables;
+      TRandom3 m_split;
       std::vector< std::string > m_methods;
       std::map< std::string, std::string > m_method_strings;
       std::map< std::string, std::string > m_methods_options;
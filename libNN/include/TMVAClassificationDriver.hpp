@@ -0,0 +1,98 @@
+#ifndef TMVAClassificationDriver_HPP
+#define TMVAClassificationDriver_HPP 1
+
+// STL include
+#include <map>
+#include <string>
+#include <vector>
+
+// ROOT include
+#include "Rtypes.h"
+#include "TFile.h"
+
+namespace NN {
+
+  // A single method / option string combination trained in its own worker.
+  struct TrainingJob {
+
+    std::string name;      // unique label, names the job directory
+    std::string method;    // key in DefinedMVAs
+    std::string options;   // option string, empty uses the DefinedMVAs default
+  };
+
+  // Test sample performance read back from a finished job.
+  struct TrainingSummary {
+
+    std::string name;
+    std::string method;
+    bool ok;
+    Double_t rocIntegral;
+    Double_t separation;
+    Double_t effS001;
+    Double_t effS010;
+    Double_t effS030;
+  };
+
+  /** @class TMVAClassificationDriver TMVAClassificationDriver.hpp
+  *
+  *  Trains independent method and option string combinations in parallel.
+  *
+  *  ROOT and TMVA keep global state, so every job is trained in a forked
+  *  worker process with its own TMVAClassification, Factory, output file
+  *  and weight directory under <jobDir>/<name>. Once all workers have
+  *  finished the summaries are collected and, for every method, the weight
+  *  files of the job with the best ROC integral are copied to the common
+  *  weights directory under the names TMVAReader expects.
+  *
+  *  Run the driver before opening any writable ROOT file in the parent,
+  *  the workers inherit everything open at fork time.
+  */
+
+  class TMVAClassificationDriver {
+
+    public:
+
+      TMVAClassificationDriver( const std::vector< std::string >& inputVars, const std::string& jobDir = "training", const std::string& weightsDir = "weights" );
+
+      // Input tuple with the signal and background selections and weight expressions.
+      void setInput( const std::string& inputFile, const std::string& treePath, const std::string& signalCut = "nsig>1.01", const std::string& backgroundCut = "nbkg>1.01", const std::string& sWeight = "nbkg_B_sw", const std::string& bWeight = "nsig_S_sw" );
+      void setOptimise( const bool& optimise = true ) { m_optimise = optimise; }
+
+      // Book a method with its default option string, or a named option variant.
+      void addMethod( const std::string& method, const std::string& options = "" );
+      void addJob( const std::string& name, const std::string& method, const std::string& options = "" );
+
+      // Train all jobs with at most nWorkers running at once. Returns false if any job failed.
+      bool run( const unsigned int& nWorkers );
+
+      const std::vector< TrainingSummary >& summaries() const { return m_summaries; }
+      void printSummary() const;
+
+    private:
+
+      int trainJob( const TrainingJob& job ) const;
+      // Train on the input tree of an open file, the classifier is gone before the file is closed.
+      int trainTree( const TrainingJob& job, TFile* file ) const;
+      TrainingSummary readSummary( const TrainingJob& job, const bool& ok ) const;
+      void mergeWeights() const;
+      bool copyFile( const std::string& from, const std::string& to ) const;
+      std::string jobPath( const TrainingJob& job ) const { return m_jobDir + "/" + job.name; }
+
+      std::vector< std::string > m_inputVars;
+      std::string m_jobDir;
+      std::string m_weightsDir;
+      std::string m_inputFile;
+      std::string m_treePath;
+      std::string m_signalCut;
+      std::string m_backgroundCut;
+      std::string m_sWeight;
+      std::string m_bWeight;
+      bool m_optimise;
+
+      std::vector< TrainingJob > m_jobs;
+      std::vector< TrainingSummary > m_summaries;
+  };
+
+}
+
+#endif // TMVAClassificationDriver_HPP
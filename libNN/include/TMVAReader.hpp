@@ -19,6 +19,8 @@
 #include "TreeWriter.hpp"
 #include "TreeReader.hpp"
 #include "DefinedMVAs.hpp"
+#include "BDTBatchEvaluator.hpp"
+#include "FeatureMatrix.hpp"
 
 // Boost include
 #include "boost/shared_ptr.hpp"
@@ -62,6 +64,12 @@ namespace NN {
       // Get the mva value
       Float_t getMvaValue( const std::string& method ) ;
       Float_t getMvaValue( const TString& method ) ;
+      // Get the mva values for a batch of events, each holding the input values in
+      // the order the variables were set. BDT methods are scored block-wise.
+      std::vector< Float_t > getMvaValues( const std::string& method, const std::vector< std::vector< Float_t > >& events ) ;
+      // Same for a feature matrix, its columns are matched to the input variables by name.
+      std::vector< Float_t > getMvaValues( const std::string& method, const FeatureMatrix& events ) ;
+      const std::vector< std::string >& getVariables() const { return m_inputVars; }
       // Gets the mva error
       Float_t getMvaError( const std::string& method ) ;
       Float_t getMvaError( const TString& method ) ;
@@ -72,7 +80,9 @@ namespace NN {
     private:
 
       void updateVariables( const unsigned int& i );
+      void readVariables( const unsigned int& i, std::vector< Float_t >& event );
       void setMvaError( const TString& method ) ;
+      boost::shared_ptr< BDTBatchEvaluator > makeBatchEvaluator( const std::string& method, const FeatureMatrix& events );
   
       TMVA::Reader* m_tmvaReader;
       TreeWriter* m_treeWriter;
@@ -80,6 +90,10 @@ namespace NN {
       std::string m_outputFile;
   
       std::map< std::string, Float_t > m_variables;
+      std::vector< std::string > m_inputVars;
+      std::map< std::string, TMVA::IMethod* > m_methods;
+      std::map< std::string, std::string > m_weightfiles;
+      std::map< std::string, boost::shared_ptr< BDTBatchEvaluator > > m_batchEvaluators;
       std::map< std::string, Float_t > m_errors;
       std::vector< std::string > m_nn_outputs;
       bool m_addedMVA;
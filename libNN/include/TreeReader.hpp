@@ -35,13 +35,17 @@ namespace NN {
       double double_value;
       int int_value;
       bool bool_value;
-      float float_array[2000];
-      float double_array[2000];
+      // Array branches only, sized to the longest entry of any tree in the chain.
+      std::vector< float > float_array;
+      std::vector< double > double_array;
+      std::vector< int > int_array;
       int arraySize;
       Types type;
       int m_nGets;
       TTreeFormula *m_formula;
       Float_t evaluateFormula( const int& i ) const;
+      // Buffer the branch is read into, resized to arraySize for arrays.
+      void* address();
 
   };
 
@@ -80,6 +84,7 @@ namespace NN {
 
     private:
       bool partialSort();
+      void sizeArrays();
  
       TChain* m_fChain;
       std::vector<variable*> m_varList;
@@ -0,0 +1,269 @@
+// STL include
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+// ROOT include
+#include "TMVA/Event.h"
+#include "TMVA/TransformationHandler.h"
+
+// Local include
+#include "BDTBatchEvaluator.hpp"
+
+using namespace NN;
+
+const std::size_t BDTBatchEvaluator::m_blockSize;
+
+
+//**************************************************************************************************************************
+BDTBatchEvaluator::BDTBatchEvaluator( TMVA::MethodBDT* method, const std::string& weightfile ) throw( BDTBatchEvaluatorException )
+  : m_method( method ), m_nVars( 0 ), m_gradBoost( false ), m_useYesNoLeaf( true ), m_norm( 0. ) {
+
+  if( m_method == 0 )
+    throw BDTBatchEvaluatorException("Method is not a BDT");
+
+  readOptions( weightfile );
+
+  const std::vector< TMVA::DecisionTree* >& forest = m_method->GetForest();
+  const std::vector< double >& boostWeights = m_method->GetBoostWeights();
+  if( forest.empty() || ( !m_gradBoost && boostWeights.size() < forest.size() ) )
+    throw BDTBatchEvaluatorException("Forest is empty or has no boost weights");
+
+  m_nVars = m_method->GetNvar();
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Flatten every tree into the node arrays, keeping TMVA's tree order so the sum is accumulated
+  // ---- in exactly the same sequence as MethodBDT does.
+  for( std::size_t itree(0); itree < forest.size(); ++itree ) {
+
+    std::vector< Float_t > lower( m_nVars, -std::numeric_limits< Float_t >::infinity() );
+    std::vector< Float_t > upper( m_nVars, std::numeric_limits< Float_t >::infinity() );
+    UInt_t depth(0);
+
+    m_treeRoot.push_back( flatten( forest[itree], forest[itree]->GetRoot(), lower, upper, depth, 0 ) );
+    m_treeDepth.push_back( depth );
+
+    // Gradient boosted trees are summed unweighted, the others are normalised by the boost weights
+    const Double_t weight = m_gradBoost ? 1. : boostWeights[itree];
+    m_treeWeight.push_back( weight );
+    m_norm += weight;
+  }
+}
+
+
+//**************************************************************************************************************************
+void BDTBatchEvaluator::readOptions( const std::string& weightfile ) throw( BDTBatchEvaluatorException ) {
+
+  std::ifstream infile( weightfile.c_str() );
+  if( !infile )
+    throw BDTBatchEvaluatorException("Can't open weight file " + weightfile);
+
+  std::stringstream buffer;
+  buffer << infile.rdbuf();
+  const std::string xml = buffer.str();
+
+  // Options are written as <Option name="BoostType" modified="Yes">AdaBoost</Option>
+  std::map< std::string, std::string > options;
+  const std::string names[] = { "BoostType", "UseYesNoLeaf", "UseFisherCuts" };
+  for( std::size_t i(0); i < sizeof(names)/sizeof(names[0]); ++i ) {
+
+    std::string::size_type pos = xml.find( "name=\"" + names[i] + "\"" );
+    if( pos == std::string::npos ) continue;
+    const std::string::size_type begin = xml.find( '>', pos );
+    const std::string::size_type end = xml.find( '<', begin );
+    if( begin == std::string::npos || end == std::string::npos ) continue;
+    options[ names[i] ] = xml.substr( begin + 1, end - begin - 1 );
+  }
+
+  const std::string boostType = options.count("BoostType") ? options["BoostType"] : "AdaBoost";
+  if( boostType == "Grad" ) {
+    m_gradBoost = true;
+    m_useYesNoLeaf = false;
+  } else if( boostType == "AdaBoost" || boostType == "Bagging" ) {
+    m_gradBoost = false;
+    m_useYesNoLeaf = !options.count("UseYesNoLeaf") || options["UseYesNoLeaf"].find_first_of("Tt1") == 0;
+  } else {
+    throw BDTBatchEvaluatorException("Unsupported BoostType " + boostType);
+  }
+
+  if( options.count("UseFisherCuts") && options["UseFisherCuts"].find_first_of("Tt1") == 0 )
+    throw BDTBatchEvaluatorException("Fisher cuts are not supported");
+}
+
+
+//**************************************************************************************************************************
+UInt_t BDTBatchEvaluator::flatten( const TMVA::DecisionTree* tree, const TMVA::DecisionTreeNode* node, std::vector< Float_t >& lower, std::vector< Float_t >& upper, UInt_t& depth, const UInt_t& level ) throw( BDTBatchEvaluatorException ) {
+
+  if( node == 0 )
+    throw BDTBatchEvaluatorException("Intermediate node without daughters");
+
+  const UInt_t index = m_selector.size();
+  m_selector.push_back( 0 );
+  m_cutValue.push_back( 0. );
+  m_cutType.push_back( 0 );
+  m_children.push_back( index );
+  m_children.push_back( index );
+  m_leafValue.push_back( 0. );
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Leaf: loops back onto itself. Its value is whatever CheckEvent returns for an event that lands
+  // ---- here, which is built from the cut boundaries collected on the way down.
+  if( node->GetNodeType() != 0 ) {
+
+    depth = std::max( depth, level );
+
+    std::vector< Float_t > values( m_nVars, 0. );
+    bool reachable(true);
+    for( UInt_t ivar(0); ivar < m_nVars; ++ivar ) {
+
+      if( !( lower[ivar] < upper[ivar] ) ) {
+        reachable = false;
+        break;
+      }
+      if( lower[ivar] > -std::numeric_limits< Float_t >::infinity() )
+        values[ivar] = lower[ivar];
+      else if( upper[ivar] < std::numeric_limits< Float_t >::infinity() )
+        values[ivar] = std::nextafter( upper[ivar], -std::numeric_limits< Float_t >::infinity() );
+    }
+
+    if( reachable ) {
+      const TMVA::Event event( values, 0 );
+      m_leafValue[index] = tree->CheckEvent( &event, m_useYesNoLeaf );
+    }
+
+    return index;
+  }
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Intermediate node: GoesRight is ( x >= cut ) for cut type true, ( x < cut ) otherwise
+  if( node->GetSelector() < 0 )
+    throw BDTBatchEvaluatorException("Fisher cuts are not supported");
+
+  const UInt_t ivar = node->GetSelector();
+  const Float_t cut = node->GetCutValue();
+  const bool cutType = node->GetCutType();
+
+  m_selector[index] = ivar;
+  m_cutValue[index] = cut;
+  m_cutType[index] = cutType ? 1 : 0;
+
+  const Float_t oldLower = lower[ivar];
+  const Float_t oldUpper = upper[ivar];
+
+  // x >= cut branch
+  lower[ivar] = std::max( oldLower, cut );
+  const UInt_t above = flatten( tree, cutType ? node->GetRight() : node->GetLeft(), lower, upper, depth, level + 1 );
+  lower[ivar] = oldLower;
+
+  // x < cut branch
+  upper[ivar] = std::min( oldUpper, cut );
+  const UInt_t below = flatten( tree, cutType ? node->GetLeft() : node->GetRight(), lower, upper, depth, level + 1 );
+  upper[ivar] = oldUpper;
+
+  m_children[ 2 * index ] = cutType ? below : above;
+  m_children[ 2 * index + 1 ] = cutType ? above : below;
+
+  return index;
+}
+
+
+//**************************************************************************************************************************
+void BDTBatchEvaluator::evaluate( const Float_t* events, const std::size_t& nEvents, Float_t* mva ) const {
+
+  std::vector< Float_t > lanes( m_nVars * m_blockSize );
+  std::vector< Float_t > values( m_nVars );
+  std::vector< UInt_t > node( m_blockSize );
+  std::vector< Double_t > sum( m_blockSize );
+  std::vector< bool > valid( m_blockSize );
+
+  for( std::size_t first(0); first < nEvents; first += m_blockSize ) {
+
+    const std::size_t n = std::min( m_blockSize, nEvents - first );
+
+    // --------------------------------------------------------------------------------------------------
+    // ---- Apply the method's variable transformation and transpose the block into per-variable lanes
+    for( std::size_t r(0); r < n; ++r ) {
+
+      const Float_t* row = events + ( first + r ) * m_nVars;
+      values.assign( row, row + m_nVars );
+
+      // TMVA::Reader refuses events with NaN inputs and returns -999
+      valid[r] = true;
+      for( UInt_t ivar(0); ivar < m_nVars; ++ivar ) {
+        if( std::isnan( values[ivar] ) ) valid[r] = false;
+      }
+
+      const TMVA::Event event( values, 0 );
+      const TMVA::Event* transformed = m_method->GetTransformationHandler().Transform( &event );
+      for( UInt_t ivar(0); ivar < m_nVars; ++ivar ) {
+        lanes[ ivar * m_blockSize + r ] = transformed->GetValue( ivar );
+      }
+    }
+
+    // --------------------------------------------------------------------------------------------------
+    // ---- Walk all rows of the block through one tree at a time. Leaves loop onto themselves so every
+    // ---- row takes the same number of steps and the row loop carries no branch.
+    std::fill( sum.begin(), sum.end(), 0. );
+    for( std::size_t itree(0); itree < m_treeRoot.size(); ++itree ) {
+
+      std::fill( node.begin(), node.begin() + n, m_treeRoot[itree] );
+
+      for( UInt_t level(0); level < m_treeDepth[itree]; ++level ) {
+        for( std::size_t r(0); r < n; ++r ) {
+          const UInt_t k = node[r];
+          const UInt_t right = ( lanes[ m_selector[k] * m_blockSize + r ] >= m_cutValue[k] ) == ( m_cutType[k] != 0 );
+          node[r] = m_children[ 2 * k + right ];
+        }
+      }
+
+      const Double_t weight = m_treeWeight[itree];
+      for( std::size_t r(0); r < n; ++r ) {
+        sum[r] += weight * m_leafValue[ node[r] ];
+      }
+    }
+
+    // --------------------------------------------------------------------------------------------------
+    // ---- Same output mapping as MethodBDT::PrivateGetMvaValue
+    for( std::size_t r(0); r < n; ++r ) {
+
+      Double_t value(-999.);
+      if( valid[r] ) {
+        if( m_gradBoost )
+          value = 2.0 / ( 1.0 + std::exp( -2.0 * sum[r] ) ) - 1;
+        else
+          value = ( m_norm > std::numeric_limits< double >::epsilon() ) ? sum[r] / m_norm : 0;
+      }
+      mva[ first + r ] = static_cast< Float_t >( value );
+    }
+  }
+}
+
+
+//**************************************************************************************************************************
+std::vector< Float_t > BDTBatchEvaluator::evaluate( const std::vector< std::vector< Float_t > >& events ) const {
+
+  std::vector< Float_t > rows;
+  rows.reserve( events.size() * m_nVars );
+
+  std::vector< std::vector< Float_t > >::const_iterator iter = events.begin();
+  const std::vector< std::vector< Float_t > >::const_iterator enditer = events.end();
+  for( ; iter != enditer; ++iter ) {
+
+    if( iter->size() != m_nVars ) {
+      std::cerr << "ERROR: BDTBatchEvaluator - event has " << iter->size() << " variables, expected " << m_nVars << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    rows.insert( rows.end(), iter->begin(), iter->end() );
+  }
+
+  std::vector< Float_t > mva( events.size() );
+  if( !events.empty() )
+    evaluate( &rows[0], events.size(), &mva[0] );
+
+  return mva;
+}
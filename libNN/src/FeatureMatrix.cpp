@@ -0,0 +1,77 @@
+// STL include
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+// Local include
+#include "FeatureMatrix.hpp"
+
+using namespace NN;
+
+
+//**************************************************************************************************************************
+FeatureMatrix::FeatureMatrix( const std::vector< std::string >& columns )
+  : m_names( columns ) {
+
+}
+
+
+//**************************************************************************************************************************
+void FeatureMatrix::addRow( const std::vector< Float_t >& values ) {
+
+  if( values.size() != m_names.size() ) {
+    std::cerr << "ERROR: FeatureMatrix - row has " << values.size() << " values, expected " << m_names.size() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  m_data.insert( m_data.end(), values.begin(), values.end() );
+}
+
+
+//**************************************************************************************************************************
+int FeatureMatrix::index( const std::string& column ) const {
+
+  std::vector< std::string >::const_iterator it = std::find( m_names.begin(), m_names.end(), column );
+  return it == m_names.end() ? -1 : static_cast< int >( it - m_names.begin() );
+}
+
+
+//**************************************************************************************************************************
+FeatureMatrix FeatureMatrix::select( const std::vector< std::string >& columns ) const {
+
+  std::vector< std::size_t > indices;
+  for( std::vector< std::string >::const_iterator it = columns.begin(); it != columns.end(); ++it ) {
+
+    const int i = index( *it );
+    if( i < 0 ) {
+      std::cerr << "ERROR: FeatureMatrix - column " << *it << " does not exist." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    indices.push_back( i );
+  }
+
+  FeatureMatrix selected( columns );
+  selected.m_data.resize( rows() * columns.size() );
+
+  const std::size_t nRows = rows();
+  for( std::size_t i(0); i < nRows; ++i ) {
+    for( std::size_t j(0); j < indices.size(); ++j ) {
+      selected( i, j ) = (*this)( i, indices[j] );
+    }
+  }
+
+  return selected;
+}
+
+
+//**************************************************************************************************************************
+FeatureMatrix FeatureMatrix::slice( const std::size_t& first, const std::size_t& last ) const {
+
+  FeatureMatrix sliced( m_names );
+  const std::size_t end = std::min( last, rows() );
+  if( first < end ) {
+    sliced.m_data.assign( m_data.begin() + first * m_names.size(), m_data.begin() + end * m_names.size() );
+  }
+
+  return sliced;
+}
@@ -1,19 +1,107 @@
 // STL include
 #include <cstdlib>
+#include <fstream>
 
 // ROOT include
 #include "TString.h"
 #include "TCut.h"
+#include "TLeaf.h"
+#include "TTreeFormula.h"
 
 // Local include
 #include "TMVAClassification.hpp"
 
 using namespace NN;
 
+namespace {
+
+  // A tree column read straight from its leaf, or through a formula if it is not a plain branch.
+  class TreeColumn {
+
+    public:
+      TreeColumn( const std::string& name ) : m_name( name ), m_leaf( 0 ), m_formula( 0 ) { }
+      ~TreeColumn() { delete m_formula; }
+
+      const std::string& name() const { return m_name; }
+      bool plain( TTree* tree ) const { return tree->GetLeaf( m_name.c_str() ) != 0; }
+      void attach( TTree* tree ) {
+        m_leaf = tree->GetLeaf( m_name.c_str() );
+        if( m_leaf == 0 && m_formula == 0 ) {
+          m_formula = new TTreeFormula( m_name.c_str(), m_name.c_str(), tree );
+        }
+        if( m_formula != 0 ) m_formula->UpdateFormulaLeaves();
+      }
+      Double_t value() const { return m_leaf != 0 ? m_leaf->GetValue() : m_formula->EvalInstance(); }
+
+    private:
+      TreeColumn( const TreeColumn& );
+      TreeColumn& operator=( const TreeColumn& );
+
+      std::string m_name;
+      TLeaf* m_leaf;
+      TTreeFormula* m_formula;
+  };
+
+  // A cut "column op threshold"; anything that does not parse is taken as a formula which passes if non-zero.
+  class Selection {
+
+    public:
+      Selection( const std::string& cut ) : m_op( "!=" ), m_threshold( 0. ) {
+
+        static const char* ops[] = { ">=", "<=", "==", "!=", ">", "<" };
+        std::string name( cut );
+        for( std::size_t i(0); i < sizeof(ops)/sizeof(ops[0]); ++i ) {
+
+          const std::string::size_type pos = cut.find( ops[i] );
+          if( pos == std::string::npos ) continue;
+
+          const std::string lhs = trim( cut.substr( 0, pos ) );
+          const std::string rhs = trim( cut.substr( pos + std::string( ops[i] ).size() ) );
+          char* end(0);
+          const Double_t threshold = std::strtod( rhs.c_str(), &end );
+          if( !lhs.empty() && !rhs.empty() && *end == '\0' && lhs.find_first_of( "<>=!()+-*/&|" ) == std::string::npos ) {
+            name = lhs;
+            m_op = ops[i];
+            m_threshold = threshold;
+          }
+          break;
+        }
+        m_column = new TreeColumn( name );
+      }
+      ~Selection() { delete m_column; }
+
+      TreeColumn& column() { return *m_column; }
+      bool pass() const {
+        const Double_t x = m_column->value();
+        if( m_op == ">" )  return x >  m_threshold;
+        if( m_op == ">=" ) return x >= m_threshold;
+        if( m_op == "<" )  return x <  m_threshold;
+        if( m_op == "<=" ) return x <= m_threshold;
+        if( m_op == "==" ) return x == m_threshold;
+        return x != m_threshold;
+      }
+
+    private:
+      Selection( const Selection& );
+      Selection& operator=( const Selection& );
+
+      static std::string trim( const std::string& s ) {
+        const std::string::size_type first = s.find_first_not_of( " \t" );
+        if( first == std::string::npos ) return "";
+        return s.substr( first, s.find_last_not_of( " \t" ) - first + 1 );
+      }
+
+      TreeColumn* m_column;
+      std::string m_op;
+      Double_t m_threshold;
+  };
+
+}
+
 
 //**************************************************************************************************************************
 TMVAClassification::TMVAClassification( const std::vector< std::string >& mvaMethods, const std::vector< std::string >& inputvars, const std::string& outname )
-  : m_tmvaFactory(  new TMVA::Factory( "TMVAClassification", TFile::Open( outname.c_str(), "RECREATE"), "!V:!Silent:Color:DrawProgressBar:Transformations=I;D;P;G,D:AnalysisType=Classification" ) ), m_variablesset( false ), m_prepareTestAndTrain( false ), m_methodset( false ), m_sigandbackset( false ), m_methods( mvaMethods ) {
+  : m_outputFile( TFile::Open( outname.c_str(), "RECREATE") ), m_tmvaFactory(  new TMVA::Factory( "TMVAClassification", m_outputFile, "!V:!Silent:Color:DrawProgressBar:Transformations=I;D;P;G,D:AnalysisType=Classification" ) ), m_variablesset( false ), m_prepareTestAndTrain( false ), m_methodset( false ), m_sigandbackset( false ), m_split( 100 ), m_methods( mvaMethods ) {
   m_method_strings.clear();
   m_methods_options.clear();
   //bookMethods();
@@ -23,7 +111,7 @@ TMVAClassification::TMVAClassification( const std::vector< std::string >& mvaMet
 
 //**************************************************************************************************************************
 TMVAClassification::TMVAClassification( const std::vector< std::string >& mvaMethods, const std::map< std::string, std::string >& input_vars_options, const std::string& outname ) 
-  : m_tmvaFactory(  new TMVA::Factory( "TMVAClassification", TFile::Open( outname.c_str(), "RECREATE"), "!V:!Silent:Color:DrawProgressBar:Transformations=I;D;P;G,D:AnalysisType=Classification" ) ), m_variablesset( false ), m_prepareTestAndTrain( false ), m_methodset( false ), m_sigandbackset( false ), m_methods_options( input_vars_options ) {
+  : m_outputFile( TFile::Open( outname.c_str(), "RECREATE") ), m_tmvaFactory(  new TMVA::Factory( "TMVAClassification", m_outputFile, "!V:!Silent:Color:DrawProgressBar:Transformations=I;D;P;G,D:AnalysisType=Classification" ) ), m_variablesset( false ), m_prepareTestAndTrain( false ), m_methodset( false ), m_sigandbackset( false ), m_split( 100 ), m_methods_options( input_vars_options ) {
 
   std::map< std::string, std::string >::const_iterator it = m_methods_options.begin();
   const std::map< std::string, std::string >::const_iterator endit = m_methods_options.end();
@@ -51,6 +139,10 @@ TMVAClassification::~TMVAClassification() {
   // clean up
 
   delete m_tmvaFactory; m_tmvaFactory = 0;
+  if( m_outputFile != 0 ) {
+    m_outputFile->Close();
+    delete m_outputFile; m_outputFile = 0;
+  }
 }
 
 
@@ -178,6 +270,7 @@ void TMVAClassification::setVariables( const std::vector< std::string >& inputVa
   for( ; iter != iterend; ++iter ) {
 
     m_tmvaFactory->AddVariable( iter->c_str(), 'F' );
+    m_variables.push_back( *iter );
   }
   m_variablesset = true;
 }
@@ -221,6 +314,142 @@ void TMVAClassification::setSignalAndBackgroundTrees( TTree* signal, TTree* back
 }
 
 
+//**************************************************************************************************************************
+void TMVAClassification::addEvent( const bool& signal, const std::vector< Double_t >& event, const Double_t& weight ) {
+
+  // Half of each class goes to training, as SplitMode=Random with nTrain=0 would do
+  const bool training = m_split.Rndm() < 0.5;
+  if( signal ) {
+    if( training ) m_tmvaFactory->AddSignalTrainingEvent( event, weight );
+    else m_tmvaFactory->AddSignalTestEvent( event, weight );
+  } else {
+    if( training ) m_tmvaFactory->AddBackgroundTrainingEvent( event, weight );
+    else m_tmvaFactory->AddBackgroundTestEvent( event, weight );
+  }
+}
+
+
+//**************************************************************************************************************************
+void TMVAClassification::setSignalAndBackground( const FeatureMatrix& signal, const FeatureMatrix& background, const std::vector< Double_t >& signalWeights, const std::vector< Double_t >& backgroundWeights ) {
+
+  if( signal.empty() || background.empty() ) {
+    std::cerr << "ERROR: signal or background sample is empty." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  const FeatureMatrix* samples[] = { &signal, &background };
+  const std::vector< Double_t >* weights[] = { &signalWeights, &backgroundWeights };
+
+  std::vector< Double_t > event( m_variables.size() );
+  for( unsigned int k(0); k < 2; ++k ) {
+
+    // Resolve the variable columns once
+    std::vector< int > columns;
+    for( std::vector< std::string >::const_iterator it = m_variables.begin(); it != m_variables.end(); ++it ) {
+      columns.push_back( samples[k]->index( *it ) );
+      if( columns.back() < 0 ) {
+        std::cerr << "ERROR: variable " << *it << " is not a column of the " << ( k == 0 ? "signal" : "background" ) << " sample." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    const std::size_t nRows = samples[k]->rows();
+    for( std::size_t i(0); i < nRows; ++i ) {
+
+      const Float_t* row = samples[k]->row( i );
+      for( std::size_t j(0); j < columns.size(); ++j ) {
+        event[j] = row[ columns[j] ];
+      }
+      addEvent( k == 0, event, weights[k]->empty() ? 1. : weights[k]->at( i ) );
+    }
+  }
+
+  std::cout << "INFO: Added " << signal.rows() << " signal and " << background.rows() << " background events." << std::endl;
+  m_sigandbackset = true;
+}
+
+
+//**************************************************************************************************************************
+void TMVAClassification::setSignalAndBackground( TTree* tree, const std::string& signalCut, const std::string& backgroundCut, const std::string& sWeight, const std::string& bWeight ) {
+
+  if( tree == 0 ) {
+    std::cerr << "ERROR: input tree is not set." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  Selection isSignal( signalCut ), isBackground( backgroundCut );
+  std::vector< TreeColumn* > columns;
+  for( std::vector< std::string >::const_iterator it = m_variables.begin(); it != m_variables.end(); ++it ) {
+    columns.push_back( new TreeColumn( *it ) );
+  }
+  TreeColumn* sWeightColumn = sWeight.empty() ? 0 : new TreeColumn( sWeight );
+  TreeColumn* bWeightColumn = bWeight.empty() ? 0 : new TreeColumn( bWeight );
+
+  std::vector< TreeColumn* > all( columns );
+  all.push_back( &isSignal.column() );
+  all.push_back( &isBackground.column() );
+  if( sWeightColumn != 0 ) all.push_back( sWeightColumn );
+  if( bWeightColumn != 0 ) all.push_back( bWeightColumn );
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Only read the branches we need, unless something has to go through a formula
+  bool plain(true);
+  for( std::size_t j(0); j < all.size(); ++j ) {
+    plain = plain && all[j]->plain( tree );
+  }
+  if( plain ) {
+    tree->SetBranchStatus( "*", 0 );
+    for( std::size_t j(0); j < all.size(); ++j ) {
+      tree->SetBranchStatus( all[j]->name().c_str(), 1 );
+    }
+  }
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Single pass, every row is tested against both selections
+  std::vector< Double_t > event( m_variables.size() );
+  Long64_t nSignal(0), nBackground(0);
+  Int_t treeNumber(-1);
+  const Long64_t nEntries = tree->GetEntries();
+  for( Long64_t i(0); i < nEntries; ++i ) {
+
+    if( tree->LoadTree( i ) < 0 ) break;
+    if( tree->GetTreeNumber() != treeNumber ) {
+      treeNumber = tree->GetTreeNumber();
+      for( std::size_t j(0); j < all.size(); ++j ) all[j]->attach( tree );
+    }
+    tree->GetEntry( i );
+
+    const bool signal = isSignal.pass();
+    const bool background = isBackground.pass();
+    if( !signal && !background ) continue;
+
+    for( std::size_t j(0); j < columns.size(); ++j ) {
+      event[j] = columns[j]->value();
+    }
+    if( signal ) {
+      addEvent( true, event, sWeightColumn != 0 ? sWeightColumn->value() : 1. );
+      ++nSignal;
+    }
+    if( background ) {
+      addEvent( false, event, bWeightColumn != 0 ? bWeightColumn->value() : 1. );
+      ++nBackground;
+    }
+  }
+
+  if( plain ) tree->SetBranchStatus( "*", 1 );
+  for( std::size_t j(0); j < columns.size(); ++j ) delete columns[j];
+  delete sWeightColumn;
+  delete bWeightColumn;
+
+  std::cout << "INFO: Selected " << nSignal << " signal (" << signalCut << ") and " << nBackground << " background (" << backgroundCut << ") events from " << nEntries << " entries." << std::endl;
+  if( nSignal == 0 || nBackground == 0 ) {
+    std::cerr << "ERROR: signal or background sample is empty." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  m_sigandbackset = true;
+}
+
+
 //**************************************************************************************************************************
 bool TMVAClassification::train( const bool& optimise ) const {
   
@@ -324,3 +553,31 @@ void TMVAClassification::summary() const {
   std::cout << " completed. " << std::endl;
 
 }
+
+
+//**************************************************************************************************************************
+void TMVAClassification::writeSummary( const std::string& filename ) const {
+
+  std::ofstream summaryFile( filename.c_str() );
+  if( !summaryFile ) {
+    std::cerr << "WARNING: TMVAClassification - could not open summary file " << filename << std::endl;
+    return;
+  }
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- method ROCIntegral separation effS@effB=0.01 effS@effB=0.10 effS@effB=0.30
+  std::map< std::string, TMVA::MethodBase* >::const_iterator it = m_method_factory.begin();
+  const std::map< std::string, TMVA::MethodBase* >::const_iterator endit = m_method_factory.end();
+  for( ; it != endit; ++it ) {
+
+    if( it->second == 0 ) continue;
+
+    Double_t err(0.);
+    summaryFile << it->first << " " 
+                << it->second->GetROCIntegral() << " "
+                << it->second->GetSeparation() << " "
+                << it->second->GetEfficiency( "Efficiency:0.01", TMVA::Types::kTesting, err ) << " "
+                << it->second->GetEfficiency( "Efficiency:0.10", TMVA::Types::kTesting, err ) << " "
+                << it->second->GetEfficiency( "Efficiency:0.30", TMVA::Types::kTesting, err ) << std::endl;
+  }
+}
@@ -0,0 +1,329 @@
+// STL include
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// POSIX include
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ROOT include
+#include "TFile.h"
+#include "TTree.h"
+#include "TSystem.h"
+#include "TMVA/Config.h"
+
+// Local include
+#include "TMVAClassification.hpp"
+#include "TMVAClassificationDriver.hpp"
+
+using namespace NN;
+
+
+//**************************************************************************************************************************
+TMVAClassificationDriver::TMVAClassificationDriver( const std::vector< std::string >& inputVars, const std::string& jobDir, const std::string& weightsDir )
+  : m_inputVars( inputVars ), m_jobDir( jobDir ), m_weightsDir( weightsDir ), m_treePath( "data" ), m_signalCut( "nsig>1.01" ), m_backgroundCut( "nbkg>1.01" ), m_sWeight( "nbkg_B_sw" ), m_bWeight( "nsig_S_sw" ), m_optimise( false ) {
+
+}
+
+
+//**************************************************************************************************************************
+void TMVAClassificationDriver::setInput( const std::string& inputFile, const std::string& treePath, const std::string& signalCut, const std::string& backgroundCut, const std::string& sWeight, const std::string& bWeight ) {
+
+  m_inputFile = inputFile;
+  m_treePath = treePath;
+  m_signalCut = signalCut;
+  m_backgroundCut = backgroundCut;
+  m_sWeight = sWeight;
+  m_bWeight = bWeight;
+}
+
+
+//**************************************************************************************************************************
+void TMVAClassificationDriver::addMethod( const std::string& method, const std::string& options ) {
+
+  addJob( method, method, options );
+}
+
+
+//**************************************************************************************************************************
+void TMVAClassificationDriver::addJob( const std::string& name, const std::string& method, const std::string& options ) {
+
+  if ( DefinedMVAs.find( method ) == DefinedMVAs.end() ) {
+    std::cerr << "ERROR: MVA method " << method << " is not recognised." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector< TrainingJob >::const_iterator it = m_jobs.begin();
+  for( ; it != m_jobs.end(); ++it ) {
+    if( it->name == name ) {
+      std::cerr << "WARNING: Training job " << name << " already added, skipping." << std::endl;
+      return;
+    }
+  }
+
+  TrainingJob job;
+  job.name = name;
+  job.method = method;
+  job.options = options;
+  m_jobs.push_back( job );
+}
+
+
+//**************************************************************************************************************************
+bool TMVAClassificationDriver::run( const unsigned int& nWorkers ) {
+
+  m_summaries.clear();
+  if( m_jobs.empty() ) {
+    std::cout << "WARNING: TMVAClassificationDriver::run(). No training jobs added." << std::endl;
+    return false;
+  }
+
+  gSystem->mkdir( m_jobDir.c_str(), kTRUE );
+
+  const unsigned int workers = std::max( nWorkers, 1u );
+  std::vector< bool > status( m_jobs.size(), false );
+  std::map< pid_t, std::size_t > running;
+  std::size_t next(0);
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Keep up to nWorkers forked trainings going until every job has finished
+  while( next < m_jobs.size() || !running.empty() ) {
+
+    while( next < m_jobs.size() && running.size() < workers ) {
+
+      std::cout.flush(); std::cerr.flush(); fflush( 0 );
+      const pid_t pid = fork();
+
+      if( pid == 0 ) {
+
+        int rc( EXIT_FAILURE );
+        try {
+          rc = trainJob( m_jobs[next] );
+        } catch( const std::exception& ex ) {
+          std::cerr << "ERROR: Training job " << m_jobs[next].name << " failed: " << ex.what() << std::endl;
+        }
+        std::cout.flush(); std::cerr.flush(); fflush( 0 );
+        _exit( rc );
+
+      } else if( pid < 0 ) {
+
+        std::cerr << "WARNING: Could not fork a worker, training " << m_jobs[next].name << " in this process." << std::endl;
+        status[next] = ( trainJob( m_jobs[next] ) == EXIT_SUCCESS );
+        ++next;
+
+      } else {
+
+        std::cout << "INFO: Training job " << m_jobs[next].name << " started in process " << pid << "." << std::endl;
+        running[pid] = next++;
+      }
+    }
+
+    if( running.empty() ) continue;
+
+    int wstatus(0);
+    const pid_t pid = waitpid( -1, &wstatus, 0 );
+    if( pid < 0 ) {
+      std::cerr << "ERROR: Lost track of " << running.size() << " training workers." << std::endl;
+      break;
+    }
+
+    std::map< pid_t, std::size_t >::iterator it = running.find( pid );
+    if( it == running.end() ) continue;
+
+    status[it->second] = WIFEXITED( wstatus ) && WEXITSTATUS( wstatus ) == EXIT_SUCCESS;
+    std::cout << "INFO: Training job " << m_jobs[it->second].name << ( status[it->second] ? " finished." : " FAILED." ) << std::endl;
+    running.erase( it );
+  }
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Collect the evaluation summaries and merge the best weights per method
+  bool ok(true);
+  for( std::size_t i(0); i < m_jobs.size(); ++i ) {
+    m_summaries.push_back( readSummary( m_jobs[i], status[i] ) );
+    ok = ok && m_summaries.back().ok;
+  }
+
+  mergeWeights();
+
+  return ok;
+}
+
+
+//**************************************************************************************************************************
+int TMVAClassificationDriver::trainJob( const TrainingJob& job ) const {
+
+  // The weight directory is global TMVA state. Restore it afterwards, jobs can run in this process when fork fails.
+  TString& weightFileDir = ( TMVA::gConfig().GetIONames() ).fWeightFileDir;
+  const TString savedWeightFileDir( weightFileDir );
+
+  const std::string dir = jobPath( job );
+  gSystem->mkdir( ( dir + "/weights" ).c_str(), kTRUE );
+  weightFileDir = ( dir + "/weights" ).c_str();
+
+  int rc( EXIT_FAILURE );
+  TFile* file = TFile::Open( m_inputFile.c_str() );
+  try {
+
+    if( file == 0 || file->IsZombie() ) {
+      std::cerr << "ERROR: Could not open input file " << m_inputFile << std::endl;
+    } else {
+      rc = trainTree( job, file );
+    }
+
+  } catch( ... ) {
+    delete file;
+    weightFileDir = savedWeightFileDir;
+    throw;
+  }
+
+  delete file;
+  weightFileDir = savedWeightFileDir;
+  return rc;
+}
+
+
+//**************************************************************************************************************************
+int TMVAClassificationDriver::trainTree( const TrainingJob& job, TFile* file ) const {
+
+  TTree* tree = dynamic_cast< TTree* >( file->Get( m_treePath.c_str() ) );
+  if( tree == 0 ) {
+    std::cerr << "ERROR: Could not find tree " << m_treePath << " in " << m_inputFile << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const std::string dir = jobPath( job );
+  const std::vector< std::string > methods( 1, job.method );
+  TMVAClassification classifier( methods, m_inputVars, dir + "/TMVA.root" );
+  if( !job.options.empty() ) {
+    classifier.setMethodOption( job.method, job.options );
+  }
+
+  classifier.setSignalAndBackground( tree, m_signalCut, m_backgroundCut, m_sWeight, m_bWeight );
+  classifier.prepareTestAndTrain();
+  classifier.bookMethods();
+
+  if( !classifier.train( m_optimise ) ) {
+    return EXIT_FAILURE;
+  }
+
+  classifier.writeSummary( dir + "/summary.txt" );
+  return EXIT_SUCCESS;
+}
+
+
+//**************************************************************************************************************************
+TrainingSummary TMVAClassificationDriver::readSummary( const TrainingJob& job, const bool& ok ) const {
+
+  TrainingSummary summary;
+  summary.name = job.name;
+  summary.method = job.method;
+  summary.ok = false;
+  summary.rocIntegral = summary.separation = summary.effS001 = summary.effS010 = summary.effS030 = 0.;
+
+  if( !ok ) return summary;
+
+  std::ifstream summaryFile( ( jobPath( job ) + "/summary.txt" ).c_str() );
+  std::string line;
+  while( std::getline( summaryFile, line ) ) {
+
+    std::istringstream is( line );
+    std::string method;
+    is >> method;
+    if( method != job.method ) continue;
+
+    is >> summary.rocIntegral >> summary.separation >> summary.effS001 >> summary.effS010 >> summary.effS030;
+    summary.ok = !is.fail();
+  }
+
+  if( !summary.ok ) {
+    std::cerr << "WARNING: No evaluation summary found for training job " << job.name << std::endl;
+  }
+
+  return summary;
+}
+
+
+//**************************************************************************************************************************
+void TMVAClassificationDriver::mergeWeights() const {
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Pick the job with the best ROC integral for every method
+  std::map< std::string, std::size_t > best;
+  for( std::size_t i(0); i < m_summaries.size(); ++i ) {
+
+    if( !m_summaries[i].ok ) continue;
+
+    std::map< std::string, std::size_t >::iterator it = best.find( m_summaries[i].method );
+    if( it == best.end() || m_summaries[i].rocIntegral > m_summaries[it->second].rocIntegral ) {
+      best[ m_summaries[i].method ] = i;
+    }
+  }
+
+  gSystem->mkdir( m_weightsDir.c_str(), kTRUE );
+
+  std::map< std::string, std::size_t >::const_iterator it = best.begin();
+  for( ; it != best.end(); ++it ) {
+
+    const std::string prefix = "/TMVAClassification_" + it->first;
+    const std::string from = jobPath( m_jobs[it->second] ) + "/weights" + prefix;
+    const std::string to = m_weightsDir + prefix;
+
+    if( copyFile( from + ".weights.xml", to + ".weights.xml" ) ) {
+      std::cout << "INFO: Using weights of training job " << m_jobs[it->second].name << " for " << it->first << "." << std::endl;
+      copyFile( from + ".class.C", to + ".class.C" );
+    } else {
+      std::cerr << "WARNING: Could not copy weight file " << from << ".weights.xml" << std::endl;
+    }
+  }
+}
+
+
+//**************************************************************************************************************************
+bool TMVAClassificationDriver::copyFile( const std::string& from, const std::string& to ) const {
+
+  std::ifstream in( from.c_str(), std::ios::binary );
+  if( !in ) return false;
+
+  std::ofstream out( to.c_str(), std::ios::binary );
+  out << in.rdbuf();
+  return out.good();
+}
+
+
+//**************************************************************************************************************************
+void TMVAClassificationDriver::printSummary() const {
+
+  std::vector< std::pair< Double_t, std::size_t > > order;
+  for( std::size_t i(0); i < m_summaries.size(); ++i ) {
+    order.push_back( std::make_pair( -m_summaries[i].rocIntegral, i ) );
+  }
+  std::sort( order.begin(), order.end() );
+
+  const std::ios_base::fmtflags flags = std::cout.flags();
+  const std::streamsize precision = std::cout.precision();
+
+  std::cout << "INFO: Training summary, ordered by ROC integral" << std::endl;
+  std::cout << std::setw(20) << "Job" << std::setw(12) << "Method" << std::setw(10) << "ROC" << std::setw(12) << "Separation"
+            << std::setw(10) << "@B=0.01" << std::setw(10) << "@B=0.10" << std::setw(10) << "@B=0.30" << std::endl;
+
+  for( std::size_t i(0); i < order.size(); ++i ) {
+
+    const TrainingSummary& s = m_summaries[ order[i].second ];
+    std::cout << std::setw(20) << s.name << std::setw(12) << s.method;
+    if( s.ok ) {
+      std::cout << std::fixed << std::setprecision(3) << std::setw(10) << s.rocIntegral << std::setw(12) << s.separation
+                << std::setw(10) << s.effS001 << std::setw(10) << s.effS010 << std::setw(10) << s.effS030 << std::endl;
+    } else {
+      std::cout << std::setw(10) << "FAILED" << std::endl;
+    }
+  }
+
+  std::cout.flags( flags );
+  std::cout.precision( precision );
+}
@@ -1,5 +1,6 @@
 // STL include
 #include <cstdlib>
+#include <algorithm>
 #include <limits>       // std::numeric_limits
 
 // ROOT include
@@ -16,7 +17,7 @@ using namespace NN;
 //**************************************************************************************************************************
 TMVAReader::TMVAReader() 
   //: IClassifierReader(), m_tmvaReader( boost::make_shared< TMVA::Reader >( "!Color:!Silent" ) ), m_outputFile( "outputFile.root" ) {
-  : m_tmvaReader( new TMVA::Reader( "!Color:!Silent" ) ), m_outputFile( "outputFile.root" ), m_addedMVA(false), m_errorStore(false) {
+  : m_tmvaReader( new TMVA::Reader( "!Color:!Silent" ) ), m_treeWriter( 0 ), m_treeReader( 0 ), m_outputFile( "outputFile.root" ), m_addedMVA(false), m_errorStore(false) {
 
 }
 
@@ -24,7 +25,7 @@ TMVAReader::TMVAReader()
 //**************************************************************************************************************************
 TMVAReader::TMVAReader( const std::vector< std::string >& mvaMethods, const std::vector< std::string >& inputVars, const std::string outputFile, const std::string& weightsDirPrefix )
   //: IClassifierReader(), m_tmvaReader( boost::make_shared< TMVA::Reader >( "!Color:!Silent" ) ), m_outputFile( outputFile ) {
-  : m_tmvaReader( new TMVA::Reader( "!Color:!Silent" ) ), m_outputFile( outputFile ), m_nn_outputs( mvaMethods ), m_addedMVA(false), m_errorStore(false)  {
+  : m_tmvaReader( new TMVA::Reader( "!Color:!Silent" ) ), m_treeWriter( 0 ), m_treeReader( 0 ), m_outputFile( outputFile ), m_nn_outputs( mvaMethods ), m_addedMVA(false), m_errorStore(false)  {
 
   
   setVariables( inputVars );
@@ -44,7 +45,8 @@ TMVAReader::TMVAReader( const std::vector< std::string >& mvaMethods, const std:
       TString methodName = TString( *it + " method");
       TString weightfile = dir + prefix + "_" + TString( *it + ".weights.xml");
       std::cout << "weight file = " << weightfile << std::endl; 
-      m_tmvaReader->BookMVA( methodName, weightfile );
+      m_methods[*it] = m_tmvaReader->BookMVA( methodName, weightfile );
+      m_weightfiles[*it] = weightfile.Data();
       m_errors.insert( std::make_pair( *it, 0. ) );
       m_addedMVA = true; 
     } else {
@@ -92,6 +94,7 @@ void TMVAReader::setVariables( const std::vector< std::string >& inputVars ) {
   // ---- Add the input variables that were used in the Classification 
   for( ; iter != iterend; ++iter ) {
     m_variables.insert( std::make_pair( *iter, 0. ) );
+    m_inputVars.push_back( *iter );
     m_tmvaReader->AddVariable( iter->c_str(), &m_variables[*iter] );
   } 
 
@@ -113,15 +116,43 @@ void  TMVAReader::fillTuple() {
       }
     }
 
-    // --------------------------------------------------------------------------------------------------
-    // ---- Begin looping over tuple and adding entries
     int N = getEntries();
-    TMVA::Timer timer( N, "TMVAReader", kTRUE );
-    for ( int i(0); i < N; ++i ) {
-    
-      updateVariables( i );
-      m_treeWriter->write( i );
-      timer.DrawProgressBar( i );
+    if( !m_errorStore ) {
+
+      // --------------------------------------------------------------------------------------------------
+      // ---- Read the inputs once and score every method over the whole tuple in one batch
+      std::vector< std::vector< Float_t > > events( N, std::vector< Float_t >( m_inputVars.size() ) );
+      for ( int i(0); i < N; ++i ) {
+        readVariables( i, events[i] );
+      }
+
+      std::map< std::string, std::vector< Float_t > > scores;
+      for( std::vector< std::string >::iterator iter = m_nn_outputs.begin(); iter != m_nn_outputs.end(); ++iter ) {
+        scores[ *iter ] = getMvaValues( *iter, events );
+      }
+
+      // --------------------------------------------------------------------------------------------------
+      // ---- Begin looping over tuple and adding entries
+      TMVA::Timer timer( N, "TMVAReader", kTRUE );
+      for ( int i(0); i < N; ++i ) {
+
+        for( std::vector< std::string >::iterator iter = m_nn_outputs.begin(); iter != m_nn_outputs.end(); ++iter ) {
+          m_treeWriter->column( "nn_" + *iter, scores[ *iter ][i] );
+        }
+        m_treeWriter->write( i );
+        timer.DrawProgressBar( i );
+      }
+    } else {
+
+      // --------------------------------------------------------------------------------------------------
+      // ---- Begin looping over tuple and adding entries
+      TMVA::Timer timer( N, "TMVAReader", kTRUE );
+      for ( int i(0); i < N; ++i ) {
+
+        updateVariables( i );
+        m_treeWriter->write( i );
+        timer.DrawProgressBar( i );
+      }
     }
     std::cout << "INFO: Reader finished and new tuple created." << std::endl;
   } else {
@@ -193,6 +224,104 @@ Float_t TMVAReader::getMvaValue( const TString& method ) {
 }
 
 
+//**************************************************************************************************************************
+std::vector< Float_t > TMVAReader::getMvaValues( const std::string& method, const std::vector< std::vector< Float_t > >& events ) {
+
+  FeatureMatrix matrix( m_inputVars );
+  matrix.reserve( events.size() );
+  std::vector< std::vector< Float_t > >::const_iterator iter = events.begin();
+  const std::vector< std::vector< Float_t > >::const_iterator enditer = events.end();
+  for( ; iter != enditer; ++iter ) {
+    matrix.addRow( *iter );
+  }
+
+  return getMvaValues( method, matrix );
+}
+
+
+//**************************************************************************************************************************
+std::vector< Float_t > TMVAReader::getMvaValues( const std::string& method, const FeatureMatrix& events ) {
+
+  if( events.names() != m_inputVars ) {
+    return getMvaValues( method, events.select( m_inputVars ) );
+  }
+
+  if( m_errors.find( method ) == m_errors.end() ) {
+    std::cerr << "WARNING: TMVAReader - getMvaValues has issue as method containing name " << method << " does not exist.\n";
+    return std::vector< Float_t >( events.rows(), -std::numeric_limits< Float_t >::max() );
+  }
+
+  const std::size_t nEvents = events.rows();
+  std::vector< Float_t > mva( nEvents );
+  if( nEvents == 0 ) {
+    return mva;
+  }
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- BDT forests are flattened once and scored block-wise
+  std::map< std::string, boost::shared_ptr< BDTBatchEvaluator > >::iterator it = m_batchEvaluators.find( method );
+  if( it == m_batchEvaluators.end() ) {
+    it = m_batchEvaluators.insert( std::make_pair( method, makeBatchEvaluator( method, events ) ) ).first;
+  }
+  if( it->second ) {
+    it->second->evaluate( events.row( 0 ), nEvents, &mva[0] );
+    return mva;
+  }
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Everything else goes through the reader one event at a time
+  for( std::size_t i(0); i < nEvents; ++i ) {
+
+    const Float_t* row = events.row( i );
+    for( unsigned int ivar(0); ivar < m_inputVars.size(); ++ivar ) {
+      setVariable( m_inputVars[ivar], row[ivar] );
+    }
+    mva[i] = getMvaValue( method );
+  }
+
+  return mva;
+}
+
+
+//**************************************************************************************************************************
+boost::shared_ptr< BDTBatchEvaluator > TMVAReader::makeBatchEvaluator( const std::string& method, const FeatureMatrix& events ) {
+
+  boost::shared_ptr< BDTBatchEvaluator > evaluator;
+
+  TMVA::MethodBDT* bdt = dynamic_cast< TMVA::MethodBDT* >( m_methods[ method ] );
+  if( bdt == 0 ) {
+    return evaluator;
+  }
+
+  try {
+    evaluator = boost::make_shared< BDTBatchEvaluator >( bdt, m_weightfiles[ method ] );
+  } catch( const BDTBatchEvaluatorException& ex ) {
+    std::cerr << "WARNING: TMVAReader - " << ex.what() << ", scoring " << method << " event by event." << std::endl;
+    return boost::shared_ptr< BDTBatchEvaluator >();
+  }
+
+  // --------------------------------------------------------------------------------------------------
+  // ---- Cross check the first events against the reader before trusting the flattened forest
+  const std::size_t nSample = std::min< std::size_t >( events.rows(), 16 );
+  std::vector< Float_t > batch( nSample );
+  evaluator->evaluate( events.row( 0 ), nSample, &batch[0] );
+  for( std::size_t i(0); i < nSample; ++i ) {
+
+    const Float_t* row = events.row( i );
+    for( unsigned int ivar(0); ivar < m_inputVars.size(); ++ivar ) {
+      setVariable( m_inputVars[ivar], row[ivar] );
+    }
+    if( batch[i] != getMvaValue( method ) ) {
+      std::cerr << "WARNING: TMVAReader - batch response for " << method << " differs from TMVA, scoring event by event." << std::endl;
+      return boost::shared_ptr< BDTBatchEvaluator >();
+    }
+  }
+
+  std::cout << "INFO: TMVAReader - scoring " << method << " in batches over " << evaluator->nTrees() << " trees." << std::endl;
+  return evaluator;
+}
+
+
 //**************************************************************************************************************************
 void TMVAReader::setVariable( const std::string& name, const Float_t& value ) {
 
@@ -205,6 +334,18 @@ void TMVAReader::setVariable( const std::string& name, const Float_t& value ) {
 }
 
 
+//**************************************************************************************************************************
+void TMVAReader::readVariables( const unsigned int& i, std::vector< Float_t >& event ) {
+
+  m_treeReader->GetEntry( i );
+
+  event.resize( m_inputVars.size() );
+  for ( unsigned int ivar(0); ivar < m_inputVars.size(); ++ivar ) {
+    event[ivar] = m_treeReader->GetValue( m_inputVars[ivar] );
+  }
+}
+
+
 //**************************************************************************************************************************
 void TMVAReader::updateVariables( const unsigned int& i ) {
 
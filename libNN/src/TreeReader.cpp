@@ -12,6 +12,38 @@
 using namespace NN;
 //ClassImp(TreeReader)
 
+namespace {
+
+  // Number of values a leaf can hold in one entry, 0 for scalars. Variable
+  // length arrays use the largest count written to the leaf's tree.
+  int arrayLength( const TLeaf* leaf ) {
+    const TLeaf* count = leaf->GetLeafCount();
+    if ( count == 0 && leaf->GetLenStatic() <= 1 ) return 0;
+    return leaf->GetLenStatic() * ( count != 0 ? std::max( count->GetMaximum(), 1 ) : 1 );
+  }
+
+}
+
+void* variable::address() {
+
+  switch ( type )
+  {
+      case FLOAT:
+          if ( arraySize > 0 ) { float_array.resize( arraySize ); return &float_array[0]; }
+          return &float_value;
+      case DOUBLE:
+          if ( arraySize > 0 ) { double_array.resize( arraySize ); return &double_array[0]; }
+          return &double_value;
+      case INT:
+          if ( arraySize > 0 ) { int_array.resize( arraySize ); return &int_array[0]; }
+          return &int_value;
+      case BOOL:
+          return &bool_value;
+      default:
+          return 0;
+  }
+}
+
 Float_t variable::evaluateFormula( const int& i ) const {
   Float_t value = -999;
   if( m_formula != 0 ) { 
@@ -91,18 +123,8 @@ void TreeReader::Initialize()
         tmpVar->name = leaf->GetName();
         tmpVar->bname = branch->GetName();
         tmpVar->title = leaf->GetTitle();
-        // This does not work before reading event and even then I would have
-        // to make assumption.
-        //tmpVar->arraySize=leaf->GetLen();
-        // Find out whether we have array by inspecting leaf title
-        if ( tmpVar->title.find("[")!=std::string::npos )
-        {
-            tmpVar->arraySize=2000; // Dirty hack, tree knows actual size, I do not have to
-        }
-        else
-        {
-            tmpVar->arraySize=0;
-        }
+        // Arrays get a buffer as long as the longest entry, scalars none
+        tmpVar->arraySize=arrayLength( leaf );
         tmpVar->m_nGets=0;
 
         if ( strcmp(leaf->GetTypeName(),"Float_t")==0 )
@@ -121,36 +143,20 @@ void TreeReader::Initialize()
         {
             tmpVar->type=DOUBLE;
         }
-
-        variable* lastAdded=tmpVar;
-
-        switch (lastAdded->type)
+        else
         {
-            case FLOAT:
-                if ( lastAdded->arraySize>1 )
-                    m_fChain->SetBranchAddress(lastAdded->bname.c_str(),(void*)lastAdded->float_array);
-                else
-                    m_fChain->SetBranchAddress(lastAdded->bname.c_str(),(void*)&lastAdded->float_value);
-                break;
+            tmpVar->type=FORMULA; // unsupported leaf type, not read
+        }
 
-            case DOUBLE:
-                if ( lastAdded->arraySize>1 )
-                    m_fChain->SetBranchAddress(lastAdded->bname.c_str(),(void*)lastAdded->double_array);
-                else
-                    m_fChain->SetBranchAddress(lastAdded->bname.c_str(),(void*)&lastAdded->double_value);
-                break;
+        //    std::cout<<"Branch: "<<tmpVar->name<<"; "<<tmpVar->type<<"; "<<tmpVar->arraySize<<std::endl;
+    }
 
-            case INT:
-                m_fChain->SetBranchAddress(lastAdded->bname.c_str(),(void*)&lastAdded->int_value);
-                break;
+    sizeArrays();
 
-            case BOOL:
-                m_fChain->SetBranchAddress(lastAdded->bname.c_str(),(void*)&lastAdded->bool_value);
-                break;
-            default:
-                break;
-        }
-        //    std::cout<<"Branch: "<<lastAdded->name<<"; "<<lastAdded->type<<"; "<<lastAdded->arraySize<<std::endl;
+    for (std::vector<variable*>::iterator it=m_varList.begin(); it!=m_varList.end(); ++it)
+    {
+        if ( (*it)->type != FORMULA )
+            m_fChain->SetBranchAddress((*it)->bname.c_str(),(*it)->address());
     }
 
     std::cout<<"Set up "<<m_varList.size()<<" branches\n";
@@ -158,6 +164,31 @@ void TreeReader::Initialize()
 }
 
 
+/*
+ * Variable length arrays can be longer in a later tree of the chain. The
+ * buffers are sized once to the longest entry over all trees, so addresses
+ * bound to the chain and to trees from BranchNewTree never move.
+ */
+void TreeReader::sizeArrays()
+{
+    Long64_t first = 0;
+    for ( int t(0); t < m_fChain->GetNtrees(); ++t )
+    {
+        if ( m_fChain->LoadTree( first ) < 0 ) break;
+
+        for (std::vector<variable*>::iterator it=m_varList.begin(); it!=m_varList.end(); ++it)
+        {
+            variable* var=*it;
+            if ( var->arraySize <= 0 || var->type == FORMULA ) continue;
+
+            TLeaf* leaf = m_fChain->GetLeaf( var->name.c_str() );
+            if ( leaf != 0 ) var->arraySize = std::max( var->arraySize, arrayLength( leaf ) );
+        }
+        first += m_fChain->GetTree()->GetEntries();
+    }
+}
+
+
 // This needs update
 void TreeReader::BranchNewTree(TTree* tree)
 {
@@ -168,22 +199,16 @@ void TreeReader::BranchNewTree(TTree* tree)
         switch ( var->type )
         {
             case FLOAT:
-                if ( var->arraySize>1 )
-                    tree->Branch(var->name.c_str(),(void*)(var->float_array),(var->title+"/F").c_str());
-                else
-                    tree->Branch(var->name.c_str(),(void*)&(var->float_value),(var->title+"/F").c_str());
+                tree->Branch(var->name.c_str(),var->address(),(var->title+"/F").c_str());
                 break;
             case DOUBLE:
-                if ( var->arraySize>1 )
-                    tree->Branch(var->name.c_str(),(void*)(var->double_array),(var->title+"/D").c_str());
-                else
-                    tree->Branch(var->name.c_str(),(void*)&(var->double_value),(var->title+"/D").c_str());
+                tree->Branch(var->name.c_str(),var->address(),(var->title+"/D").c_str());
                 break;
             case INT:
-                tree->Branch(var->name.c_str(),(void*)&(var->int_value),(var->title+"/I").c_str());
+                tree->Branch(var->name.c_str(),var->address(),(var->title+"/I").c_str());
                 break;
             case BOOL:
-                tree->Branch(var->name.c_str(),(void*)&(var->bool_value),(var->title+"/O").c_str());
+                tree->Branch(var->name.c_str(),var->address(),(var->title+"/O").c_str());
                 break;
             default:
                 break;
@@ -240,24 +265,33 @@ Float_t TreeReader::GetValue(const std::string& name, const int& iValue)
   //  std::cout<<"Accessing branch "<<myVar->name<<" of type "<<myVar->type
   //            <<" with double value "<<myVar->double_value<<std::endl;
 
+  if ( myVar->arraySize > 0 && ( iValue < 0 || iValue >= myVar->arraySize ) )
+  {
+      std::cerr<<"WARNING: TreeReader - index "<<iValue<<" out of range for "<<name<<"["<<myVar->arraySize<<"]"<<std::endl;
+      return -999;
+  }
+
   switch (myVar->type)
   {
       case FLOAT:
-          if ( myVar->arraySize>1 )
+          if ( myVar->arraySize>0 )
               return myVar->float_array[iValue];
           else
               return myVar->float_value;
           break;
 
       case DOUBLE:
-          if ( myVar->arraySize>1 )
+          if ( myVar->arraySize>0 )
               return myVar->double_array[iValue];
           else
               return myVar->double_value;
           break;
 
       case INT:
-          return myVar->int_value;
+          if ( myVar->arraySize>0 )
+              return myVar->int_array[iValue];
+          else
+              return myVar->int_value;
           break;
 
       case BOOL:
@@ -11,3 +11,9 @@ backtestmva=BDTD
 #./bin/mva --input_file outputFile_SPX.root --tree_path data --output_file outputFile_SPX_withMVA.root -e -t  --var $variables --mva $addmvas
 
 ./bin/mvabacktest --spx_file ./db/SPX.csv --begin_date "2010-01-01" --end_date "2014-12-01" --mva_type $backtestmva --cut_min -0.01 --cut_max 0.1 --var $variables
+
+# Same workflow in one process, the tuple is optional
+#./bin/mvapipeline --spx_file ./db/SPX.csv --begin_date "2001-01-01" --split_date "2010-01-01" --end_date "2014-12-01" --mva $addmvas --mva_type $backtestmva --var $variables
+
+# Walk forward: retrain on 9 year windows, trade each following year out of sample
+#./bin/mvapipeline --spx_file ./db/SPX.csv --begin_date "2001-01-01" --end_date "2014-12-01" --train_months 108 --test_months 12 --mva_type $backtestmva --var $variables -j 4